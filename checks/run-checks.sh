@@ -0,0 +1,304 @@
+#!/bin/bash
+# Regression checks of the spreadsheet editor
+# Each table is edited in all modes of the editor (see run_mode()) and all of them must give the same result as
+# the original implementation (the expected table of the check).
+# Usage: ./checks/run-checks.sh SPS_BINARY
+
+if [ $# -ne 1 ] || [ ! -x "$1" ]; then
+    echo "Usage: $0 SPS_BINARY" >&2
+    exit 2
+fi
+
+SPS=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+MODES="default indexed paged in-place pipe snapshot output compact"
+if command -v gzip > /dev/null; then
+    MODES="$MODES gzip"
+fi
+PARALLEL_MODES="default in-place pipe output compact"
+if command -v gzip > /dev/null; then
+    PARALLEL_MODES="$PARALLEL_MODES gzip"
+fi
+CHECKS=0
+FAILURES=0
+
+# Edits the table in the file by the editor in the given mode: run_mode MODE FILE ARGS...
+run_mode() {
+    local mode=$1 file=$2
+    shift 2
+
+    case $mode in
+        default)
+            "$SPS" "$@" "$file" ;;
+        indexed)
+            # The file is indexed by editing it without changes at first, its index is used by the edit then
+            "$SPS" -i "${@:1:$#-1}" '[1,1]' "$file" && "$SPS" -i "$@" "$file"
+            local status=$?
+            rm -f "$file.spsidx"
+            return $status ;;
+        paged)
+            "$SPS" -m 1 "$@" "$file" ;;
+        in-place)
+            "$SPS" --in-place "$@" "$file" ;;
+        pipe)
+            # The table is read from the standard input and written into the standard output
+            "$SPS" "$@" - < "$file" > "$file.out" && mv "$file.out" "$file" ;;
+        snapshot)
+            # The file is converted into the binary snapshot, edited and converted back into the text (also after
+            # the failed edit, the snapshot mustn't be changed by it)
+            "$SPS" --save-binary "${@:1:$#-1}" '[1,1]' "$file" || return
+            "$SPS" "$@" "$file"
+            local status=$?
+            "$SPS" --save-text "${@:1:$#-1}" '[1,1]' "$file" && return $status ;;
+        output)
+            # The edited table is written into another file, the input one mustn't be changed
+            cp "$file" "$file.orig"
+            "$SPS" -o "$file.out" "$@" "$file" || return
+            if ! cmp -s "$file" "$file.orig"; then
+                echo "the input file has been changed" >&2
+                return 1
+            fi
+            mv "$file.out" "$file" ;;
+        compact)
+            "$SPS" -c "$@" "$file" ;;
+        gzip)
+            gzip -c "$file" > "$file.gz" && "$SPS" "$@" "$file.gz" && gzip -dc "$file.gz" > "$file" ;;
+    esac
+}
+
+# Reports the failed check: fail MODE NAME MESSAGE
+fail() {
+    echo "FAIL [$1] $2: $3"
+    FAILURES=$((FAILURES + 1))
+}
+
+# Checks the edited table in all modes: check NAME INPUT EXPECTED ARGS...
+check() {
+    local name=$1 input=$2 expected=$3
+    shift 3
+
+    printf '%s' "$expected" > "$WORK/expected.txt"
+    for mode in $MODES; do
+        CHECKS=$((CHECKS + 1))
+        printf '%s' "$input" > "$WORK/table.txt"
+        if ! run_mode "$mode" "$WORK/table.txt" "$@" 2> "$WORK/errors.txt"; then
+            fail "$mode" "$name" "the editor failed ($(cat "$WORK/errors.txt"))"
+        elif ! cmp -s "$WORK/table.txt" "$WORK/expected.txt"; then
+            fail "$mode" "$name" "unexpected table"
+            diff "$WORK/expected.txt" "$WORK/table.txt"
+        fi
+    done
+}
+
+# Checks that the editor fails and the table stays unchanged in all modes: check_error NAME INPUT ARGS...
+check_error() {
+    local name=$1 input=$2
+    shift 2
+
+    printf '%s' "$input" > "$WORK/expected.txt"
+    for mode in $MODES; do
+        CHECKS=$((CHECKS + 1))
+        printf '%s' "$input" > "$WORK/table.txt"
+        if run_mode "$mode" "$WORK/table.txt" "$@" 2> /dev/null; then
+            fail "$mode" "$name" "the editor didn't fail"
+        elif ! cmp -s "$WORK/table.txt" "$WORK/expected.txt"; then
+            fail "$mode" "$name" "the table has been changed"
+        fi
+    done
+}
+
+# Generates the big table with the given number of rows: generate_table ROWS
+generate_table() {
+    awk -v rows="$1" 'BEGIN { for (i = 1; i <= rows; i++) print i, i % 97, "cell" i % 13, (i % 5 ? "a" : "\"b c\"") }'
+}
+
+# Checks the edited big table in all modes by its checksum (output of cksum): check_big NAME ROWS EXPECTED ARGS...
+check_big() {
+    local name=$1 rows=$2 expected=$3
+    shift 3
+
+    generate_table "$rows" > "$WORK/big.txt"
+    for mode in $MODES; do
+        CHECKS=$((CHECKS + 1))
+        cp "$WORK/big.txt" "$WORK/table.txt"
+        if ! run_mode "$mode" "$WORK/table.txt" "$@" 2> "$WORK/errors.txt"; then
+            fail "$mode" "$name" "the editor failed ($(cat "$WORK/errors.txt"))"
+        elif [ "$(cksum < "$WORK/table.txt")" != "$expected" ]; then
+            fail "$mode" "$name" "unexpected table"
+        fi
+    done
+}
+
+# Checks if the edited file is replaced by a new one (its inode is changed), the table is compressed by gzip with
+# COMPRESSED=yes (the kept compressed file mustn't be recompressed): check_replaced NAME REPLACED ARGS...
+check_replaced() {
+    local name=$1 replaced=$2 file=$WORK/table.txt
+    shift 2
+
+    CHECKS=$((CHECKS + 1))
+    if [ "$COMPRESSED" = yes ]; then
+        file=$WORK/table.gz
+        printf 'a b c\nd e f\n' | gzip -9 -n > "$file"
+    else
+        printf 'a b c\nd e f\n' > "$file"
+    fi
+    cp "$file" "$WORK/expected.bin"
+    local before after
+    before=$(ls -i "$file" | cut -d ' ' -f 1)
+    if ! "$SPS" "$@" "$file" 2> "$WORK/errors.txt"; then
+        fail "-" "$name" "the editor failed ($(cat "$WORK/errors.txt"))"
+        return
+    fi
+    after=$(ls -i "$file" | cut -d ' ' -f 1)
+    if [ "$replaced" = yes ] && [ "$before" = "$after" ]; then
+        fail "-" "$name" "the file hasn't been replaced"
+    elif [ "$replaced" = no ] && [ "$before" != "$after" ]; then
+        fail "-" "$name" "the file has been replaced"
+    elif [ "$COMPRESSED" = yes ] && [ "$replaced" = no ] && ! cmp -s "$file" "$WORK/expected.bin"; then
+        fail "-" "$name" "the file has been changed"
+    fi
+}
+
+# Checks if the output of the compressed table is compressed (only when the file is written back or the name
+# of the output asks for it): check_output_compression NAME OUTPUT COMPRESSED ARGS...
+check_output_compression() {
+    local name=$1 output=$2 compressed=$3
+    shift 3
+
+    CHECKS=$((CHECKS + 1))
+    printf 'a b c\nd e f\n' | gzip -c > "$WORK/table.gz"
+    if ! "$SPS" -o "$output" "$@" '[1,2];set x' "$WORK/table.gz" > "$WORK/stdout.bin" 2> "$WORK/errors.txt"; then
+        fail gzip "$name" "the editor failed ($(cat "$WORK/errors.txt"))"
+        return
+    fi
+    [ "$output" = - ] && output=$WORK/stdout.bin
+    if [ "$compressed" = yes ] && ! gzip -t "$output" 2> /dev/null; then
+        fail gzip "$name" "the output isn't compressed"
+    elif [ "$compressed" = no ] && [ "$(cat "$output")" != $'a x c\nd e f' ]; then
+        fail gzip "$name" "the output isn't plain text"
+    fi
+}
+
+# Checks that the compressed table isn't edited, when it can't be decompressed or loaded: check_decompression_error NAME PATH
+check_decompression_error() {
+    local name=$1
+    CHECKS=$((CHECKS + 1))
+    cp "$WORK/table.gz" "$WORK/expected.gz"
+    if PATH=$2 "$SPS" '[1,1];set x' "$WORK/table.gz" 2> /dev/null; then
+        fail gzip "$name" "the editor didn't fail"
+    elif ! cmp -s "$WORK/table.gz" "$WORK/expected.gz"; then
+        fail gzip "$name" "the table has been changed"
+    fi
+}
+
+# Commands of the editor
+check 'set a cell' $'Name Age City\nAnna 30 Brno\nPetr 25 "Nove Mesto"\nJana 41 Praha\n' $'Name Age City\nAnna 30 Olomouc\nPetr 25 "Nove Mesto"\nJana 41 Praha\n' '[2,3];set Olomouc'
+check 'set a value with spaces' $'Name Age City\nAnna 30 Brno\nPetr 25 "Nove Mesto"\nJana 41 Praha\n' $'"Full name" Age City\nAnna 30 Brno\nPetr 25 "Nove Mesto"\nJana 41 Praha\n' '[1,1];set Full\ name'
+check 'set a whole column' $'Name Age City\nAnna 30 Brno\nPetr 25 "Nove Mesto"\nJana 41 Praha\n' $'Name 0 City\nAnna 0 Brno\nPetr 0 "Nove Mesto"\nJana 0 Praha\n' '[_,2];set 0'
+check 'set all cells' $'1 2 3\n4 5 6\n7 8 9\n' $'x x x\nx x x\nx x x\n' '[_,_];set x'
+check 'clear a row' $'Name Age City\nAnna 30 Brno\nPetr 25 "Nove Mesto"\nJana 41 Praha\n' $'Name Age City\nAnna 30 Brno\n  \nJana 41 Praha\n' '[3,_];clear'
+check 'swap cells' $'Name Age City\nAnna 30 Brno\nPetr 25 "Nove Mesto"\nJana 41 Praha\n' $'Name Age City\nJana 30 Brno\nPetr 25 "Nove Mesto"\nAnna 41 Praha\n' '[2,1];swap [4,1]'
+check 'sum and avg' $'1 2 3\n4 5 6\n7 8 9\n' $'1 2 12\n4 5 4\n7 8 9\n' '[1,1,3,1];sum [1,3];avg [2,3]'
+check 'count and len' $'Name Age City\nAnna 30 Brno\nPetr 25 "Nove Mesto"\nJana 41 Praha\n' $'4 4 City\nAnna 30 Brno\nPetr 25 "Nove Mesto"\nJana 41 Praha\n' '[_,3];count [1,1];[2,3];len [1,2]'
+check 'min and max' $'1 2 3\n4 5 6\n7 8 9\n' $'m 2 3\n4 5 6\n7 8 M\n' '[_,_];[max];set M;[_,_];[min];set m'
+check find $'Name Age City\nAnna 30 Brno\nPetr 25 "Nove Mesto"\nJana 41 Praha\n' $'Name Age City\nAnna 30 Brno\nP 25 "Nove Mesto"\nJana 41 Praha\n' '[_,_];[find Petr];set P'
+check 'temporary variables' $'1 2 3\n4 5 6\n7 8 9\n' $'1 2 3\n4 6 6\n7 8 1\n' '[1,1];def _0;[3,3];use _0;[2,2];def _1;inc _1;use _1'
+check 'saved selection' $'1 2 3\n4 5 6\n7 8 9\n' $'a 2 3\n4 b 6\n7 8 9\n' '[2,2];[set];[1,1];set a;[_];set b'
+check 'selection behind the table' $'1 2 3\n4 5 6\n7 8 9\n' $'1 2 3  \n4 5 6  \n7 8 9  \n    \n    z\n' '[5,5];set z'
+check 'custom delimiters' $'1:2;3\n4;5:6\n' $'1:"x:y":3\n4:5:6\n' -d ':;' '[1,2];set x:y'
+check 'quoted cells' $'a "b c" d\n"e" f\n' $'q\\"x "b c" d\ne f \n' '[1,1];set q"x'
+check 'short rows are aligned' $'a\nb c d\ne f\n' $'x  \nb c d\ne f \n' '[1,1];set x'
+check 'empty columns at the end are trimmed' $'a b  \nc  \n' $'a b\ny \n' '[2,1];set y'
+check 'empty table' $'' $'x\n' '[1,1];set x'
+check 'no newline at the end' $'a b\nc d' $'a b\nc e\n' '[2,2];set e'
+check_error 'invalid quoting' $'a "b\nc d\n' '[1,1];set x'
+check_error 'unknown command' $'1 2 3\n4 5 6\n7 8 9\n' '[1,1];foo'
+# The original implementation writes behind the row here (the cell isn't in the table), it's reported as an error
+check_error 'use a variable behind the row' $'1 2 3\n4 5 6\n7 8 9\n' '[2,_];[_,_];len [2,7];[min];[3,5];use _2;use _0'
+
+# Inserting and deleting columns (many of them are processed by the columnar table)
+check 'insert a column' $'a b c\nc d e\n' $'a  b c\nc  d e\n' '[1,2];icol'
+check 'append a column' $'a b c\nc d e\n' $'a b c x\nc d e \n' '[1,3];acol;[1,4];set x'
+check 'delete a column' $'a b c\nc d e\n' $'a c\nc e\n' '[1,2];dcol'
+check 'insert columns for each selected cell' $'1 2 3 4 5\n6 7 8 9 10\n11 12 13 14 15\n' $'1 x   2 3 4 5\n6    7 8 9 10\n11    12 13 14 15\n' '[_,2];icol;[1,2];set x'
+check 'insert and delete columns' $'1 2 3 4 5\n6 7 8 9 10\n11 12 13 14 15\n' $'1   3 5\ny y y y y\n11   13 15\n' '[_,1];acol;[1,3,1,5];dcol;[2,_];set y'
+check 'insert columns for many cells' $'1 2 3 4 5\n6 7 8 9 10\n11 12 13 14 15\n' $'               1 2 3 4 5\n  x             6 7 8 9 10\n               11 12 13 14 15\n' '[_,_];icol;[2,3];set x'
+check 'insert and delete columns for many cells' $'0 a 0\n1 b 1\n2 c 4\n3 d 9\n4 e 16\n5 f 25\n6 g 36\n7 h 49\n8 i 64\n9 j 81\n' $'0 a n        0\n1 b n        1\nv v v v v v v v v v v\n3 d n        9\n4 e n        16\n5 f n        25\n6 g n        36\n7 h n        49\n8 i n        64\n9 j n        81\n' '[_,2];acol;[_,3];set n;[1,4,2,4];dcol;[3,_];set v'
+check 'columns and rows' $'0 a 0\n1 b 1\n2 c 4\n3 d 9\n4 e 16\n5 f 25\n6 g 36\n7 h 49\n8 i 64\n9 j 81\n' $'z z z z z z z z z z z z\nz z z z z z z z z z z z\nz z z z z z z z z z z z\nz z z z z z z z z z z z\nz z z z z z z z z z z z\nz z z z z z z z z z z z\nz z z z z z z z z z z z\nz z z z z z z z z z z z\nz z z z z z z z z z z z\nz z z z z z z z z z z z\n' '[_,1];icol;[1,1];irow;[_,_];set z;[3,3];drow;[2,2];dcol'
+# Deleting columns behind the table deletes the last column (the original implementation reads cells behind the
+# row there, the expected tables are given by its row-major deleting of columns)
+check 'delete columns behind the table' $'a b c\nc d e\n' $'a\nc\n' '[1,2,1,3];dcol'
+check 'delete columns behind the narrow table' $'a b\nc d\n' $'\n\n' '[1,1,1,2];dcol'
+check 'delete columns of a new row' $'a b c\nc d e\n' $'\n\n\n\n\n\n\n\n\n' '[9,_];dcol'
+check 'add a column behind the row' $'a b c\nd e f\n' $'a b\nd e\n' '[1,3];dcol;acol'
+check 'insert columns behind the rows' $'a b c\nd e f\n' $'x b\nd e\n' '[1,3];dcol;[1,3];icol;acol;[1,1];set x'
+check 'insert columns behind the columnar table' $'a\nb\n' $'x\n\n' '[_,1];icol;icol;icol;icol;[1,9];dcol;acol;icol;[1,1];set x'
+
+# Inserting and deleting rows (the rows array has a gap at the last edited row)
+check 'insert a row' $'a b c\nd e f\ng h i\nj k l\n' $'a b c\nx  \nd e f\ng h i\nj k l\n' '[2,1];irow;[2,1];set x'
+check 'append a row' $'a b c\nd e f\ng h i\nj k l\n' $'a b c\nd e f\nx  \ng h i\nj k l\n' '[2,1];arow;[3,1];set x'
+check 'delete a row' $'a b c\nd e f\ng h i\nj k l\n' $'a b c\ng h i\nj k l\n' '[2,1];drow'
+check 'insert rows for each selected cell' $'a b c\nd e f\ng h i\nj k l\n' $'a b c\n  \n  \n  \nd e f\ng h i\nj k l\n' '[2,_];irow'
+check 'delete a range of rows' $'a b c\nd e f\ng h i\nj k l\n' $'a b c\ng h i\n' '[2,1,3,1];drow'
+check 'insert and delete rows' $'1 x1\n2 x2\n3 x3\n4 x4\n5 x5\n6 x6\n7 x7\n8 x8\n9 x9\n10 x10\n11 x11\n12 x12\n' $'1 x1\n2 x2\n \n3 x3\n5 x5\n6 x6\n7 x7\n8 x8\n \n9 x9\n10 x10\n11 x11\nM x12\n' '[3,1];irow;[9,1];arow;[5,1];drow;[_,1];[max];set M'
+check 'insert rows at many places' $'1 x1\n2 x2\n3 x3\n4 x4\n5 x5\n6 x6\n7 x7\n8 x8\n9 x9\n10 x10\n11 x11\n12 x12\n' $' \n \n \n \n \n \nx \n \n \n \n \n1 x1\n2 x2\n3 x3\n4 x4\n5 x5\n6 x6\n7 x7\n8 x8\n9 x9\n10 x10\n11 x11\n12 x12\n' '[_,2];irow;[7,1];set x;[19,2];drow'
+check 'append rows behind the table' $'a b c\nd e f\ng h i\nj k l\n' $'a b c\nd e f\ng h i\nj k l\n  \n  \n  \n y \n' '[6,1];arow;[8,2];set y'
+check 'delete rows behind the table' $'a b c\nd e f\ng h i\nj k l\n' $'a b c\nd e f\ng h i\nj k l\n  \n  \n' '[7,1];drow'
+check 'add a row behind the table' $'1\n2\n3\n' $'1\n2\n3\n\n' '[4,1];drow;arow'
+check 'insert rows behind the table' $'1 a\n2 b\n3 c\n' $'x a\n2 b\n \n \n \n' '[3,1];drow;[3,1];arow;irow;[1,1];set x'
+check 'insert rows behind the columnar table' $'1\n2\n3\n' $'         1\n         2\n         3\n         \n         \n' \
+    '[_,1];icol;icol;icol;[4,1];drow;arow;irow'
+# Rows behind the table delete the last row, the only row of the table is replaced by an empty one
+check 'delete all rows' $'x:y\n' $'\n' '[_,_];drow'
+check 'delete all rows of a wide table' $'a b\nc d\n' $'\n' '[_,_];drow'
+check 'delete all rows of the columnar table' $'a b\nc d\n' $'\n' '[_,_];icol;[_,_];icol;[_,_];drow'
+check 'set a cell of the table without rows' $'a b\nc d\n' $'x\n' '[_,_];drow;[1,1];set x'
+check_error 'maximum of a deleted row' $'1 2\n3 4\n5 6\n' '[3,1];drow;[max];set x'
+check_error 'length of a deleted row' $'1 2\n3 4\n5 6\n' '[3,1];drow;len [1,1]'
+check 'insert rows and columns' $'1 x1\n2 x2\n3 x3\n4 x4\n5 x5\n6 x6\n7 x7\n8 x8\n9 x9\n10 x10\n11 x11\n12 x12\n' $'            \n           2 x2\nz z z z z z z z z z z z z\n           4 x4\n           5 x5\n           6 x6\n           7 x7\n           8 x8\n           9 x9\n           10 x10\n           11 x11\n           12 x12\n' '[_,1];icol;[2,2];irow;[4,_];set z;[1,3];dcol;[11,1];drow'
+check_big 'insert rows into a big table' 40000 '2971242367 865996' '[_,1];irow'
+check_big 'insert and delete rows of a big table' 40000 '2578374220 865972' '[2,_];irow;[5,_];drow;[_,1];arow'
+
+# Big tables (rows are evicted from memory with the memory limit of 1 MiB)
+check_big 'swap cells of a big table' 100000 '3062339407 1781662' '[1,1];swap [99999,3]'
+check_big 'sum a column of a big table' 100000 '2833323119 1781672' '[_,2];sum [1,1]'
+check_big 'find cells in a big table' 100000 '616855952 1292767' '[_,_];[find cell7];[_,1];clear'
+
+# Tables bigger than loading chunks (they're loaded, processed and saved by chunks in parallel), only modes which do
+# it are checked
+MODES=$PARALLEL_MODES check_big 'sum a column of a table loaded in parallel' 600000 '1740142112 11245507' \
+    '[_,2];sum [1,1]'
+MODES=$PARALLEL_MODES check_big 'set a column of a table processed in parallel' 600000 '89812613 8707036' \
+    '[_,3];set x'
+MODES=$PARALLEL_MODES check_big 'change cells of rows saved in parallel' 600000 '2146110996 11965497' \
+    '[_,_];[find cell7];[_,4];set "q r"'
+
+# Decompressing (the decompressing process must succeed, a truncated or empty table mustn't be loaded, invalid rows
+# are found also in chunks loaded while the table is decompressed)
+if command -v gzip > /dev/null; then
+    seq 1 100000 | gzip -c | head -c 20000 > "$WORK/table.gz"
+    check_decompression_error 'truncated compressed table' "$PATH"
+    printf 'a b\nc d\n' | gzip -c > "$WORK/table.gz"
+    check_decompression_error 'missing decompressing program' "$WORK/missing"
+    { generate_table 600000; printf '1 "x\n'; } | gzip -c > "$WORK/table.gz"
+    check_decompression_error 'invalid cell at the end of a big compressed table' "$PATH"
+fi
+
+# Saving (the file is replaced atomically, only changes of the same size are patched in place with --in-place)
+check_replaced 'changed file is replaced' yes '[1,2];set x'
+check_replaced 'changed file is patched in place' no --in-place '[1,2];set x'
+check_replaced 'resized file is replaced' yes --in-place '[1,2];set xyz'
+check_replaced 'unchanged file is kept' no '[1,2]'
+check_replaced 'file with the same content is kept' no '[1,2];set b'
+if command -v gzip > /dev/null; then
+    COMPRESSED=yes check_replaced 'changed compressed file is replaced' yes '[1,2];set x'
+    COMPRESSED=yes check_replaced 'unchanged compressed file is kept' no '[_,_];[find e]'
+    COMPRESSED=yes check_replaced 'compressed file with the same content is kept' no '[1,2];set b'
+    check_output_compression 'another output file gets plain text' "$WORK/output.txt" no
+    check_output_compression 'standard output gets plain text' - no --save-text
+    check_output_compression 'output file named .gz is compressed' "$WORK/output.gz" yes
+fi
+
+echo "$CHECKS checks, $FAILURES failures"
+[ $FAILURES -eq 0 ]
@@ -8,11 +8,38 @@
  * @version 1.0
  */
 
+#define _XOPEN_SOURCE 700
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <ctype.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+/**
+ * @def SIMD_SCANNER Searching for structural chars can use SSE2 (and AVX2 if the CPU supports it) instructions
+ */
+#define SIMD_SCANNER
+#endif
+#ifdef __linux__
+#include <sys/sendfile.h>
+/**
+ * @def KERNEL_COPYING Data of the original file can be copied into the output file by the kernel (using sendfile())
+ */
+#define KERNEL_COPYING
+#endif
 
 /**
  * @def DEFAULT_DELIMITER Default delimiter for case user didn't set different
@@ -38,6 +65,10 @@
  * @def CELL_START_CAPACITY Start capacity (number of chars) for the cell
  */
 #define CELL_START_CAPACITY 1
+/**
+ * @def CELL_SHORT_CAPACITY Max number of chars of the content which is kept right in the cell (without allocation)
+ */
+#define CELL_SHORT_CAPACITY 15
 /**
  * @def ROW_START_CAPACITY Start capacity (max number of cells) for the row
  */
@@ -46,6 +77,20 @@
  * @def TABLE_START_CAPACITY Start capacity (max number of rows) for the table
  */
 #define TABLE_START_CAPACITY 1
+/**
+ * @def COLUMNAR_MIN_OPERATIONS Number of column insertions and deletions which are worth converting the table
+ *                              to the columnar one (the conversion moves all cells there and back, a single insertion
+ *                              or deletion moves a part of them)
+ */
+#define COLUMNAR_MIN_OPERATIONS 8
+/**
+ * @def ARENA_BLOCK_SIZE Size of an ordinary block of the arena (bigger allocations get their own blocks)
+ */
+#define ARENA_BLOCK_SIZE (1024 * 1024)
+/**
+ * @def ARENA_ALIGNMENT Alignment of allocations from the arena (in bytes)
+ */
+#define ARENA_ALIGNMENT 8
 /**
  * @def SPECIAL_CHARS List of special characters (they must be escaped)
  */
@@ -78,6 +123,129 @@
  * @def NUMBER_OF_VARIABLES Number of temporary data variables (_0 to _9)
  */
 #define NUMBER_OF_VARIABLES 10
+/**
+ * @def CHAR_CLASS_DELIMITER Char class flag: column delimiter
+ */
+#define CHAR_CLASS_DELIMITER 0x01
+/**
+ * @def CHAR_CLASS_LINE_BREAK Char class flag: line break (the end of the row)
+ */
+#define CHAR_CLASS_LINE_BREAK 0x02
+/**
+ * @def CHAR_CLASS_SPECIAL Char class flag: special char (char from SPECIAL_CHARS)
+ */
+#define CHAR_CLASS_SPECIAL 0x04
+/**
+ * @def CELL_RAW_ENCODED Cell flag: raw data of the cell contain borders or escape chars (they differ from the content)
+ */
+#define CELL_RAW_ENCODED 0x01
+/**
+ * @def CELL_CONTENT_DELIMITER Cell flag: content of the cell contains a column delimiter (it's saved with borders)
+ */
+#define CELL_CONTENT_DELIMITER 0x02
+/**
+ * @def CELL_CONTENT_SPECIAL Cell flag: content of the cell contains a special char or a line break (it's saved char
+ * by char)
+ */
+#define CELL_CONTENT_SPECIAL 0x04
+/**
+ * @def SIMD_MAX_DELIMITERS Maximum number of delimiters the SIMD scanner can search for (longer lists are scanned per char)
+ */
+#define SIMD_MAX_DELIMITERS 8
+/**
+ * @def LOADING_CHUNK_MIN_SIZE Minimum size of input data chunk (in bytes) that is worth loading in a separate thread
+ * (it can be given at compile time, small chunks are used for checks of the parallel loading)
+ */
+#ifndef LOADING_CHUNK_MIN_SIZE
+#define LOADING_CHUNK_MIN_SIZE (4 * 1024 * 1024)
+#endif
+/**
+ * @def MAX_LOADING_THREADS Maximum number of threads for loading the table
+ */
+#define MAX_LOADING_THREADS 64
+/**
+ * @def SAVING_CHUNK_ROWS Number of rows saved by one thread at once (long runs of rows are saved in parallel by chunks
+ * of this size), it can be given at compile time (small chunks are used for checks of the parallel saving)
+ */
+#ifndef SAVING_CHUNK_ROWS
+#define SAVING_CHUNK_ROWS 16384
+#endif
+/**
+ * @def ROW_INDEX_STRIDE Number of rows between two rows with saved offset in the row index
+ */
+#define ROW_INDEX_STRIDE 1024
+/**
+ * @def ROW_INDEX_SUFFIX Suffix of the file with row index (it's saved next to the indexed file)
+ */
+#define ROW_INDEX_SUFFIX ".spsidx"
+/**
+ * @def ROW_INDEX_MAGIC Identifier of the file with row index (and version of its format)
+ */
+#define ROW_INDEX_MAGIC "SPSIDX1"
+/**
+ * @def TABLE_SNAPSHOT_MAGIC Identifier of the binary snapshot of the table (and version of its format)
+ */
+#define TABLE_SNAPSHOT_MAGIC "SPSBIN1"
+/**
+ * @def TABLE_FORMAT_TEXT Format of the saved table: text (cells separated by delimiters, see saveTableToFile())
+ */
+#define TABLE_FORMAT_TEXT 0
+/**
+ * @def TABLE_FORMAT_SNAPSHOT Format of the saved table: binary snapshot (see saveTableToSnapshot())
+ */
+#define TABLE_FORMAT_SNAPSHOT 1
+/**
+ * @def OUTPUT_BUFFER_SIZE Size of the buffer for saved data (bigger blocks of data are written directly)
+ */
+#define OUTPUT_BUFFER_SIZE (1024 * 1024)
+/**
+ * @def COMPRESSION_NONE Compression format: data aren't compressed
+ */
+#define COMPRESSION_NONE 0
+/**
+ * @def COMPRESSION_GZIP Compression format: gzip (data are processed by gzip program)
+ */
+#define COMPRESSION_GZIP 1
+/**
+ * @def COMPRESSION_ZSTD Compression format: zstd (data are processed by zstd program)
+ */
+#define COMPRESSION_ZSTD 2
+/**
+ * @def STREAM_BUFFER_START_SIZE Start size of memory for data read from a stream (it's doubled when it's full), data
+ * are read by blocks of this size
+ */
+#define STREAM_BUFFER_START_SIZE (1024 * 1024)
+/**
+ * @def STREAM_RESERVED_SIZE Size of address space reserved for data read from a stream (a quarter of the address
+ * space, smaller one is reserved if there isn't so much of it), only its part with the read data uses memory
+ */
+#define STREAM_RESERVED_SIZE (SIZE_MAX / 4 + 1)
+/**
+ * @def STANDARD_STREAMS_FILE Name of the file for reading the standard input and writing the standard output
+ */
+#define STANDARD_STREAMS_FILE "-"
+/**
+ * @def NOT_INDEXED_ROW Number of the row in the indexed data for rows which don't come from the indexed data
+ */
+#define NOT_INDEXED_ROW UINT_MAX
+/**
+ * @def NOT_MODIFIED_ROW Number of the first modified row of the table which hasn't been modified
+ */
+#define NOT_MODIFIED_ROW UINT_MAX
+/**
+ * @def NO_ROW_GAP Position of the gap in rows of the table whose rows are stored one after another
+ */
+#define NO_ROW_GAP UINT_MAX
+/**
+ * @def OUTPUT_PATCHES_LIMIT Maximum size of the changed data which can be patched in the original file (in bytes),
+ *      the file is patched only with the --in-place option (see finishOutput())
+ */
+#define OUTPUT_PATCHES_LIMIT (16 * 1024 * 1024)
+/**
+ * @def OUTPUT_BUFFERS_COUNT Number of output buffers (filled buffers wait for the writer thread, while the next one
+ * is being filled)
+ */
+#define OUTPUT_BUFFERS_COUNT 4
 
 /**
  * @def streq(first, second) Check if first equals second
@@ -87,6 +255,32 @@
  * @def strc(str, c) Check if string (str) contains char (c)
  */
 #define strc(str, c) (strchr(str, c) != NULL)
+/**
+ * @def isDelimiter(delimiters, c) Check if char (c) is in the set of delimiters (delimiters)
+ */
+#define isDelimiter(delimiters, c) (((delimiters)->classes[(unsigned char)(c)] & CHAR_CLASS_DELIMITER) != 0)
+/**
+ * @def isSpecialChar(delimiters, c) Check if char (c) is special char (it must be escaped) using the set of delimiters
+ */
+#define isSpecialChar(delimiters, c) (((delimiters)->classes[(unsigned char)(c)] & CHAR_CLASS_SPECIAL) != 0)
+/**
+ * @def isStructuralChar(delimiters, c) Check if char (c) is delimiter, line break or special char
+ */
+#define isStructuralChar(delimiters, c) ((delimiters)->classes[(unsigned char)(c)] != 0)
+/**
+ * @def getCharFlags(delimiters, c) Get flags (CELL_CONTENT_*) of content which contains char (c) using the set
+ * of delimiters
+ */
+#define getCharFlags(delimiters, c) ((isDelimiter(delimiters, c) ? CELL_CONTENT_DELIMITER : 0) \
+                                     | (isSpecialChar(delimiters, c) || (c) == '\n' ? CELL_CONTENT_SPECIAL : 0))
+/**
+ * @def isEncodingChar(c, prevC) Check if char (c) of raw cell data is a border or an escape char (not a part of content)
+ */
+#define isEncodingChar(c, prevC) (strc(SPECIAL_CHARS, c) && (prevC) != '\\')
+/**
+ * @def getcFromMemory(position, end) Equivalent of getc() for memory buffer (position is moved forward)
+ */
+#define getcFromMemory(position, end) ((position) < (end) ? (unsigned char)*(position)++ : EOF)
 
 /**
  * @typedef Error information tells how some action ended
@@ -97,38 +291,230 @@ typedef struct errorInfo {
     bool error;
     char *message;
 } ErrorInfo;
+/**
+ * @typedef Set of column delimiters with precomputed classes of all chars (for fast lookups while parsing and saving)
+ * @field chars Delimiters as they were given (the first one is the main delimiter)
+ * @field length Number of delimiters
+ * @field classes Classes (combination of CHAR_CLASS_* flags) of each char
+ */
+typedef struct delimiterSet {
+    char *chars;
+    unsigned int length;
+    unsigned char classes[256];
+} DelimiterSet;
 /**
  * @typedef Individual table cell
- * @field data Cell's content
+ * @field content Cell's own content (use getCellData() to get it), short content is kept right in the cell
+ *                in the space of the pointer to the allocated one (see shortContent):
+ *                allocated.data - Allocated content (NULL if the cell is only a view into input data and its content
+ *                                 hasn't been needed yet)
+ *                allocated.capacity - How many chars can be in the allocated content
+ *                shortData - Short content (up to CELL_SHORT_CAPACITY chars and the last '\0')
+ * @field raw Raw data of the cell in input data (NULL if the cell hasn't been loaded or it has been changed)
  * @field size Size of the cell's content
- * @field capacity How many chars can be in the cell
+ * @field rawSize Size of the raw data
+ * @field flags Additional information about the cell (CELL_* flags)
+ * @field inArena Has the cell been allocated from the table's arena? (it's released together with the arena)
+ * @field dataInArena Has the cell's data been allocated from the table's arena? (it can't be resized or freed)
+ * @field shortContent Is the content kept in content.shortData? (content.allocated is overwritten by it then)
  */
 typedef struct cell {
-    char *data;
+    union {
+        struct {
+            char *data;
+            unsigned int capacity;
+        } allocated;
+        char shortData[CELL_SHORT_CAPACITY + 1];
+    } content;
+    const char *raw;
     unsigned int size;
-    unsigned int capacity;
+    unsigned int rawSize;
+    unsigned char flags;
+    bool inArena;
+    bool dataInArena;
+    bool shortContent;
 } Cell;
+/**
+ * @typedef Block of memory of the arena
+ * @field next Next block of the arena (NULL for the last one)
+ * @field size Size of the block's data
+ * @field used Number of bytes of the data which have been already allocated
+ * @field data Memory of the block
+ */
+typedef struct arenaBlock {
+    struct arenaBlock *next;
+    size_t size;
+    size_t used;
+    char data[];
+} ArenaBlock;
+/**
+ * @typedef Arena for small allocations which live as long as the table (cells and their content)
+ * Memory is allocated from big blocks one by one and it's released only all at once with the arena.
+ * @field blocks The first block of the arena (new allocations are made from it)
+ * @field last The last block of the arena (blocks of other arenas are appended behind it)
+ */
+typedef struct arena {
+    ArenaBlock *blocks;
+    ArenaBlock *last;
+} Arena;
+/**
+ * @typedef Index of rows in data (offsets of every stride-th row), it's saved next to the data for later use
+ * @field source Indexed data (NULL if the index is being built)
+ * @field sourceSize Size of the indexed data
+ * @field delimiters Column delimiters used in the data
+ * @field stride Number of rows between two rows with known offset
+ * @field size Number of rows in the data
+ * @field width Number of cells in each row
+ * @field offsets Offsets of rows with number divisible by stride (one for each block of rows)
+ * @field filledColumns The most filled columns (number of the last non-empty column) in rows of each block
+ * @field capacity How many blocks can be in the offsets and filledColumns arrays
+ * @field canonical Are the data in the canonical form? (loading and saving them again doesn't change them)
+ * @field lastRow Number of the last found row (rows are mostly accessed one by one, so search continues from it)
+ * @field lastPosition Start of the last found row
+ */
+typedef struct rowIndex {
+    const char *source;
+    size_t sourceSize;
+    DelimiterSet *delimiters;
+    unsigned int stride;
+    unsigned int size;
+    unsigned int width;
+    uint64_t *offsets;
+    uint32_t *filledColumns;
+    unsigned int capacity;
+    bool canonical;
+    unsigned int lastRow;
+    const char *lastPosition;
+} RowIndex;
+/**
+ * @typedef Cell of the compact row (its content is in the heap shared by all of the compact rows of the table)
+ * @field offset Offset of the cell's content in the heap (the content is ended by '\0' there)
+ * @field size Size of the cell's content
+ */
+typedef struct cellSpan {
+    uint32_t offset;
+    uint32_t size;
+} CellSpan;
+/**
+ * @typedef Paging information of the loaded row (its place in the list of loaded rows and in the scratch file)
+ * @field newer Row used just after this one (NULL for the most recently used row)
+ * @field older Row used just before this one (NULL for the least recently used row)
+ * @field memory Memory used by the row's cells (it's measured when the row stops being the most recently used one)
+ * @field listed Is the row in the list of loaded rows?
+ * @field evicted Has the row been evicted into the scratch file?
+ * @field filled Number of the last non-empty column of the evicted row
+ * @field slot Offset of the row's record in the scratch file
+ * @field slotSize Space for the row's record in the scratch file (0 if the row hasn't been evicted into it yet)
+ */
+typedef struct rowPage {
+    struct row *newer;
+    struct row *older;
+    size_t memory;
+    bool listed;
+    bool evicted;
+    unsigned int filled;
+    off_t slot;
+    size_t slotSize;
+} RowPage;
 /**
  * @typedef Individual table row
- * @field cells Cells in the row
+ * @field cells Loaded cells of the row (NULL if the row hasn't been loaded from the indexed data yet)
  * @field size Number of cells in the row
  * @field capacity How many cells can be in the row
+ * @field loaded Number of loaded cells (the other ones are only in the raw tail)
+ * @field tail Raw data of cells which haven't been loaded (with line break which ends the row), NULL if there aren't any
+ * @field tailSize Size of the raw tail
+ * @field tailFilled Number of the last non-empty column in the raw tail (0 if all of the cells in the tail are empty)
+ * @field tailCanonical Is the raw tail in the canonical form? (it can be saved as it is)
+ * @field tailDelimiters Column delimiters used in the raw tail (or in the input data of the compact row)
+ * @field source Index of data with the row (NULL if the row doesn't come from the indexed data or it's been found)
+ * @field sourceRow Number of the row in the indexed data (indexed from 0, NOT_INDEXED_ROW for other rows)
+ * @field cache Cache the row is loaded into (NULL if memory for loaded rows isn't limited)
+ * @field page Paging information of the row (NULL if the row hasn't been loaded into the cache)
+ * @field spans Cells of the compact row (NULL if the row isn't compact), the compact row has no loaded cells and no raw
+ *              tail, its cells are created when the row is changed or a cell of it is needed (see expandCompactRow())
+ * @field heap Heap with contents of cells of the compact row
  */
 typedef struct row {
     Cell **cells;
     unsigned int size;
     unsigned int capacity;
+    unsigned int loaded;
+    const char *tail;
+    unsigned int tailSize;
+    unsigned int tailFilled;
+    bool tailCanonical;
+    DelimiterSet *tailDelimiters;
+    RowIndex *source;
+    unsigned int sourceRow;
+    struct pageCache *cache;
+    RowPage *page;
+    CellSpan *spans;
+    char *heap;
 } Row;
+/**
+ * @typedef Cache of loaded rows with limited memory (the least recently used rows are evicted, when it's exceeded)
+ * Unchanged rows are evicted back into the indexed data (they're loaded from it again), changed ones are saved into
+ * the scratch file.
+ * @field index Index of data the rows are loaded from
+ * @field scratch Scratch file for evicted rows (NULL if any row hasn't been saved into it yet)
+ * @field scratchSize Size of the scratch file
+ * @field budget Maximum memory for cells of the loaded rows (in bytes)
+ * @field used Memory used by cells of the loaded rows (in bytes)
+ * @field newest The most recently used row
+ * @field oldest The least recently used row
+ */
+typedef struct pageCache {
+    RowIndex *index;
+    FILE *scratch;
+    off_t scratchSize;
+    size_t budget;
+    size_t used;
+    Row *newest;
+    Row *oldest;
+} PageCache;
+/**
+ * @typedef Column of the columnar table
+ * @field cells Cells of the column, one for each row of the table (NULL cell is empty and it's created when it's needed
+ *              for the first time), there is space for as many cells as rows can be in the table
+ */
+typedef struct column {
+    Cell **cells;
+} Column;
 /**
  * @typedef The whole table
- * @field rows Rows in the table
+ * @field rows Rows in the table, unused pointers are in the gap before the row on position gap (see getTableRow())
  * @field size Number of rows in the table
  * @field capacity How many cells can be in the row
+ * @field index Index of data the rows are loaded from (NULL if all of the rows have been loaded at once)
+ * @field cache Cache of the loaded rows (NULL if memory for them isn't limited)
+ * @field modifiedRow The first row changed since the table has been loaded (cells, rows or columns), indexed from 0
+ *                    (NOT_MODIFIED_ROW if the table hasn't been changed)
+ * @field delimiters Column delimiters of the table's data (flags of changed cells are given by them)
+ * @field arena Arena for cells of the table (NULL if cells are allocated one by one, for ex. for evicting rows)
+ * @field heap Heap with contents of cells of the compact rows (NULL if the table hasn't been loaded as compact)
+ * @field columns Columns of the columnar table (NULL if the table is row-major), cells of the columnar table are only
+ *                in its columns (its rows have no cells, see convertTableToColumns())
+ * @field width Number of columns of the columnar table
+ * @field columnsCapacity How many columns can be in the columnar table
+ * @field gap Position of the gap in rows (indexed from 0), rows behind it are at the end of the array and rows are
+ *            inserted and deleted by moving the gap (NO_ROW_GAP if rows are stored one after another, it's always true
+ *            outside processCommands())
  */
 typedef struct table {
     Row **rows;
     unsigned int size;
     unsigned int capacity;
+    RowIndex *index;
+    PageCache *cache;
+    unsigned int modifiedRow;
+    DelimiterSet *delimiters;
+    Arena *arena;
+    char *heap;
+    Column *columns;
+    unsigned int width;
+    unsigned int columnsCapacity;
+    unsigned int gap;
 } Table;
 /**
  * @typedef Command for data selection or manipulating with them
@@ -182,27 +568,341 @@ typedef struct variables {
     char *data[NUMBER_OF_VARIABLES];
     double number;
 } Variables;
+/**
+ * @typedef Part of the input data loaded independently on other parts (it always contains only whole rows)
+ * @field start Start of the chunk's data
+ * @field end End of the chunk's data (the first byte behind)
+ * @field delimiters Column delimiters
+ * @field rows Loaded rows (part of the table's array with rows, the chunk's own array while a stream is loaded)
+ * @field size Number of loaded rows
+ * @field capacity How many rows can be in the rows array (number of rows in the chunk's data)
+ * @field width Number of cells in the widest row (of the chunk while measuring, of the whole table while loading)
+ * @field columns Number of cells to load in each row (the other ones are only checked and kept as raw data)
+ * @field commands Commands applied to each row (NULL if the rows are only loaded)
+ * @field filled The most filled columns (number of the last non-empty column) in rows after applying the commands
+ * @field message Error message of the commands (NULL if they haven't failed)
+ * @field flag Result flag of the loading (LAST_ROW if the chunk has been loaded successfully)
+ * @field arena Arena for cells of the chunk's rows (NULL if cells are allocated one by one)
+ * @field heap Heap of the table for contents of cells of compact rows (NULL if the rows are loaded with their cells)
+ * @field heapOffset Offset of free space of the chunk in the heap (the chunk has as much space as its size + 1)
+ */
+typedef struct loadingChunk {
+    const char *start;
+    const char *end;
+    DelimiterSet *delimiters;
+    Row **rows;
+    unsigned int size;
+    unsigned int capacity;
+    unsigned int width;
+    unsigned int columns;
+    CommandSequence *commands;
+    unsigned int filled;
+    char *message;
+    signed char flag;
+    Arena *arena;
+    char *heap;
+    uint32_t heapOffset;
+} LoadingChunk;
+/**
+ * @typedef Chunk of a stream loaded in its own thread while the stream is read
+ * @field chunk Loaded part of the stream
+ * @field thread Thread which loads the chunk
+ * @field threadStarted Has been the thread started? (the chunk has been loaded by the reading thread otherwise)
+ */
+typedef struct streamChunk {
+    LoadingChunk chunk;
+    pthread_t thread;
+    bool threadStarted;
+} StreamChunk;
+/**
+ * @typedef Loading of a table from a stream while the stream is read (whole rows which have been read are loaded
+ *          by chunks in other threads, see continueStreamLoading())
+ * @field delimiters Column delimiters
+ * @field columns Number of cells to load in each row (the other ones are only checked and kept as raw data)
+ * @field chunks Chunks of the read data (each one is allocated separately, their threads keep pointers to them)
+ * @field count Number of the chunks
+ * @field capacity Size of the array of the chunks
+ * @field joined Number of the first chunks whose threads have already ended
+ * @field split Size of the read data which have been split into the chunks
+ * @field disabled Isn't the stream loaded anymore? (it's a binary snapshot of the table or memory for its chunks
+ *                 couldn't be allocated)
+ * @field table Loaded table (NULL if it hasn't been loaded, see the flag)
+ * @field flag Result flag of the loading (LAST_ROW if the table has been loaded, INVALID_INPUT_FORMAT if the data are
+ *             invalid)
+ */
+typedef struct streamLoading {
+    DelimiterSet *delimiters;
+    unsigned int columns;
+    StreamChunk **chunks;
+    unsigned int count;
+    unsigned int capacity;
+    unsigned int joined;
+    size_t split;
+    bool disabled;
+    Table *table;
+    signed char flag;
+} StreamLoading;
+/**
+ * @typedef Part of the table saved independently on other parts (into its own memory buffer)
+ * @field rows Saved rows (part of the table's array with rows)
+ * @field size Number of the saved rows
+ * @field delimiters Column delimiters
+ * @field output Memory buffer for the saved data
+ * @field index Index of each saved row (offsets are relative to the start of the chunk), NULL if it isn't wanted
+ * @field err Error information of the saving
+ */
+typedef struct savingChunk {
+    Row **rows;
+    unsigned int size;
+    DelimiterSet *delimiters;
+    struct outputBuffer *output;
+    RowIndex *index;
+    ErrorInfo err;
+} SavingChunk;
+/**
+ * @typedef Part of the original file which is rewritten in place by different data of the same size
+ * @field offset Position of the part in the file
+ * @field size Size of the part
+ */
+typedef struct outputPatch {
+    off_t offset;
+    size_t size;
+} OutputPatch;
+/**
+ * @typedef Block of data passed to the writer thread
+ * @field data Data of the block (the buffer is reused after writing)
+ * @field size Size of the data
+ * @field capacity Size of the buffer
+ */
+typedef struct outputBlock {
+    char *data;
+    size_t size;
+    size_t capacity;
+} OutputBlock;
+/**
+ * @typedef Compressed output file which is opened when the compared output differs from the original data
+ * @field path Path to the output file (it's replaced by the new one)
+ * @field compression Compression format of the output (COMPRESSION_* constant)
+ * @field file The new file (NULL if it hasn't been opened)
+ * @field replacementPath Path to the new file
+ * @field stream Stream of the compressing process which writes into the new file
+ * @field compressor ID of the compressing process
+ * @field pipeHandler Previous handler of SIGPIPE (it's ignored while the compressing process runs)
+ */
+typedef struct deferredOutput {
+    const char *path;
+    int compression;
+    FILE *file;
+    char *replacementPath;
+    FILE *stream;
+    pid_t compressor;
+    void (*pipeHandler)(int);
+} DeferredOutput;
+/**
+ * @typedef Buffer for data saved into a file (the data are written by big blocks, not char by char)
+ * @field descriptor File descriptor of the output file (-1 if the data are only kept in memory or if the deferred
+ *                   output hasn't been opened yet)
+ * @field data Data which haven't been written yet
+ * @field size Size of the data which haven't been written yet
+ * @field capacity Size of the buffer
+ * @field written Number of bytes which have been already written into the file (or compared with the original data)
+ * @field passed Number of bytes which have been passed to the writer (data in the buffer aren't included)
+ * @field original Original data of the file the output is compared with (NULL if the output isn't compared)
+ * @field originalSize Size of the original data
+ * @field originalData Original data (they're kept after the output has stopped being compared, so data copied from
+ *                     them are recognized)
+ * @field originalDescriptor File descriptor of the original file for copying its data by the kernel (-1 if they're
+ *                           written from memory)
+ * @field required Must be the output written even if it's the same as the original data? (the output file isn't
+ *                 the original one)
+ * @field changed Is the output different from the original data? (it's always true, if it isn't compared)
+ * @field patchDescriptor File descriptor of the original file for patching it in place (-1 if it isn't allowed)
+ * @field patches Different parts of the compared output, which have the same size as the original ones
+ * @field patchesCount Number of the different parts
+ * @field patchesCapacity Maximum number of the different parts before resizing the array
+ * @field patchesData Data of the different parts (in the same order as the parts)
+ * @field patchesSize Size of data of the different parts
+ * @field patched Has the original file been patched in place?
+ * @field threaded Are filled buffers written by the writer thread? (they're written directly otherwise)
+ * @field writer The writer thread
+ * @field lock Mutex for the queue and the spare buffers
+ * @field signal Condition signalled when a block is added into the queue or when it's written
+ * @field queue Filled blocks waiting for the writer thread (cyclic queue)
+ * @field queueStart Position of the first block in the queue
+ * @field queueCount Number of blocks in the queue (the first one stays there while it's being written)
+ * @field spares Buffers which can be filled
+ * @field sparesCount Number of the spare buffers
+ * @field stopping Should the writer thread stop after writing the queued blocks?
+ * @field writerError Error information of the writer thread (the following blocks aren't written after an error)
+ * @field blocks Filled blocks of the buffer which keeps data in memory
+ * @field blocksCount Number of the filled blocks
+ * @field blocksCapacity Maximum number of the filled blocks before resizing the array
+ * @field deferred Output file which is opened at the first difference from the original data (NULL if the file
+ *                 has been given)
+ */
+typedef struct outputBuffer {
+    int descriptor;
+    char *data;
+    size_t size;
+    size_t capacity;
+    off_t written;
+    off_t passed;
+    const char *original;
+    size_t originalSize;
+    const char *originalData;
+    int originalDescriptor;
+    bool required;
+    bool changed;
+    int patchDescriptor;
+    OutputPatch *patches;
+    unsigned int patchesCount;
+    unsigned int patchesCapacity;
+    char *patchesData;
+    size_t patchesSize;
+    bool patched;
+    bool threaded;
+    pthread_t writer;
+    pthread_mutex_t lock;
+    pthread_cond_t signal;
+    OutputBlock queue[OUTPUT_BUFFERS_COUNT];
+    unsigned int queueStart;
+    unsigned int queueCount;
+    OutputBlock spares[OUTPUT_BUFFERS_COUNT];
+    unsigned int sparesCount;
+    bool stopping;
+    ErrorInfo writerError;
+    OutputBlock *blocks;
+    unsigned int blocksCount;
+    unsigned int blocksCapacity;
+    DeferredOutput *deferred;
+} OutputBuffer;
 
 // Input/output functions
-Table *loadTableFromFile(FILE *file, char *delimiters, signed char *flag);
-Row *loadRowFromFile(FILE *file, char *delimiters, signed char *flag);
-Cell *loadCellFromFile(FILE *file, char *delimiters, signed char *flag);
+Table *loadTableFromFile(FILE *file, DelimiterSet *delimiters, signed char *flag);
+Row *loadRowFromFile(FILE *file, DelimiterSet *delimiters, Arena *arena, signed char *flag);
+Cell *loadCellFromFile(FILE *file, DelimiterSet *delimiters, Arena *arena, signed char *flag);
+Table *loadTableFromMemory(const char *data, size_t size, DelimiterSet *delimiters, unsigned int columns,
+                           bool compact, signed char *flag);
+Row *loadRowFromMemory(const char **position, const char *end, DelimiterSet *delimiters, unsigned int capacity,
+                       unsigned int columns, Arena *arena, signed char *flag);
+Row *loadCompactRowFromMemory(const char **position, const char *end, DelimiterSet *delimiters, unsigned int capacity,
+                              char *heap, uint32_t *heapOffset, signed char *flag);
+Cell *loadCellFromMemory(const char **position, const char *end, DelimiterSet *delimiters, Arena *arena,
+                         signed char *flag);
+bool scanCellFromMemory(const char **position, const char *end, DelimiterSet *delimiters, Cell *cell,
+                        signed char *flag);
+bool scanRowTailFromMemory(Row *row, const char **position, const char *end, DelimiterSet *delimiters,
+                           signed char *flag);
+void *measureChunk(void *chunk);
+void *loadChunkFromMemory(void *chunk);
+void *measureProcessedChunk(void *chunk);
+void *measureAndLoadChunk(void *chunk);
+void startStreamLoading(StreamLoading *loading, DelimiterSet *delimiters, unsigned int columns);
+void continueStreamLoading(StreamLoading *loading, const char *data, size_t size, bool end);
+void finishStreamLoading(StreamLoading *loading, bool success);
+unsigned int splitIntoLoadingChunks(const char *data, size_t size, DelimiterSet *delimiters, LoadingChunk *chunks);
+void initLoadingChunk(LoadingChunk *chunk, const char *start, const char *end, DelimiterSet *delimiters);
+long getProcessorsCount(void);
+void processChunksInParallel(void *(*function)(void *), void *chunks, size_t chunkSize, unsigned int chunksCount);
+Table *loadTableFromIndex(RowIndex *index, PageCache *cache);
+RowIndex *buildRowIndex(const char *data, size_t size, DelimiterSet *delimiters, signed char *flag);
+RowIndex *loadRowIndex(const char *path, FILE *file, const char *data, size_t size, DelimiterSet *delimiters);
+bool saveRowIndex(RowIndex *index, const char *path, const char *indexedPath);
+char *getRowIndexPath(const char *path);
+bool isTableSnapshot(const char *data, size_t size);
+Table *loadTableFromSnapshot(const char *data, size_t size, DelimiterSet *delimiters, signed char *flag);
+char *mapFileToMemory(FILE *file, size_t *size);
+ErrorInfo readStreamToMemory(FILE *file, char **data, size_t *size, size_t *mapped, StreamLoading *loading);
+int detectCompression(FILE *file);
+int getCompressionByName(const char *path);
+FILE *openCompressionFilter(int compression, int descriptor, bool compress, pid_t *process);
+bool waitForCompressionFilter(pid_t process);
+bool closeCompressionFilter(FILE *stream, pid_t process);
+FILE *openReplacementFile(const char *path, char **replacementPath);
+ErrorInfo openDeferredOutput(DeferredOutput *deferred, int *descriptor);
 CommandSequence *loadCommandsFromString(const char *string, signed char *flag);
-void saveTableToFile(Table *table, FILE *file, char *delimiters);
+ErrorInfo measureProcessedTable(const char *data, size_t size, DelimiterSet *delimiters, CommandSequence *cmdSeq,
+                                unsigned int *width, unsigned int *filled);
+ErrorInfo streamTableToFile(const char *data, size_t size, DelimiterSet *delimiters, CommandSequence *cmdSeq,
+                            unsigned int width, unsigned int filled, OutputBuffer *output, RowIndex *index);
+ErrorInfo saveTableToFile(Table *table, OutputBuffer *output, DelimiterSet *delimiters, RowIndex *index);
+ErrorInfo saveRowsInParallel(Table *table, unsigned int start, unsigned int end, OutputBuffer *output,
+                             DelimiterSet *delimiters, RowIndex *index);
+void *saveChunkToMemory(void *chunkPointer);
+ErrorInfo saveRowToFile(Row *row, OutputBuffer *output, DelimiterSet *delimiters, RowIndex *index);
+ErrorInfo saveCellToFile(Cell *cell, OutputBuffer *output, DelimiterSet *delimiters, bool *canonical);
+ErrorInfo saveTableToSnapshot(Table *table, OutputBuffer *output);
+bool syncParentDirectory(const char *path);
+OutputBuffer *createOutputBuffer(FILE *file, const char *original, size_t originalSize, int patchDescriptor,
+                                 int originalDescriptor, bool required, DeferredOutput *deferred);
+ErrorInfo writeToOutput(OutputBuffer *output, const char *data, size_t size);
+ErrorInfo writeOutputParts(OutputBuffer *output, struct iovec *parts, unsigned int count);
+ErrorInfo copyOriginalToOutput(OutputBuffer *output, const char *data, size_t size);
+bool addOutputPatch(OutputBuffer *output, const char *data, const char *original, size_t size);
+ErrorInfo writeOutputPatches(OutputBuffer *output, int descriptor);
+char *reserveOutput(OutputBuffer *output, size_t size, ErrorInfo *err);
+ErrorInfo flushOutput(OutputBuffer *output);
+void *runOutputWriter(void *outputPointer);
+ErrorInfo waitForOutputWriter(OutputBuffer *output);
+ErrorInfo stopOutputWriter(OutputBuffer *output);
+ErrorInfo passOutputBlocks(OutputBuffer *output, OutputBuffer *source);
+ErrorInfo keepOutputBlock(OutputBuffer *output);
+ErrorInfo finishOutput(OutputBuffer *output);
+void destructOutputBuffer(OutputBuffer *output);
 void writeErrorMessage(const char *message);
+DelimiterSet *createDelimiterSet(char *chars);
+void destructDelimiterSet(DelimiterSet *delimiters);
+RowIndex *createRowIndex(DelimiterSet *delimiters);
+ErrorInfo addRowToIndex(RowIndex *index, uint64_t offset, unsigned int filledColumns);
+void destructRowIndex(RowIndex *index);
+PageCache *createPageCache(size_t budget);
+void destructPageCache(PageCache *cache);
+Arena *createArena();
+void *allocateFromArena(Arena *arena, size_t size);
+void mergeArenas(Arena *arena, Arena *source);
+void destructArena(Arena *arena);
 // Functions for working with table and its components
-Table *createTable();
-Row *createRow();
-Cell *createCell();
+Table *createTable(unsigned int capacity, DelimiterSet *delimiters);
+Row *createRow(unsigned int capacity);
+Row *createIndexedRow(RowIndex *index, unsigned int sourceRow);
+Row *createCompactRow(char *heap, DelimiterSet *delimiters, unsigned int capacity);
+Cell *createCell(Arena *arena);
 ErrorInfo addRowToTable(Table *table, Row *row, unsigned int position);
 ErrorInfo addColumnToTable(Table *table, unsigned int position);
 ErrorInfo addCellToRow(Row *row, Cell *cell, unsigned int position);
+ErrorInfo reserveRowCapacity(Row *row, unsigned int capacity);
 ErrorInfo addCharToCell(Cell *cell, char c, unsigned int position);
-void deleteRowFromTable(Table *table, unsigned int position);
-void deleteColumnFromTable(Table *table, unsigned int columnNumber);
+ErrorInfo materializeCell(Cell *cell, Arena *arena);
+void copyCellContent(Cell *cell, char *destination);
+char *getCellData(Cell *cell);
+bool ownsCellData(Cell *cell);
+ErrorInfo materializeRow(Row *row, unsigned int columns);
+ErrorInfo markRowAsUsed(Row *row);
+ErrorInfo expandCompactRow(Row *row);
+void viewCompactCell(Row *row, unsigned int column, Cell *cell);
+ErrorInfo evictRows(Table *table);
+ErrorInfo evictRow(PageCache *cache, Row *row);
+ErrorInfo loadEvictedRow(Row *row);
+void unlistRow(Row *row);
+bool isRowUnchanged(Row *row, RowIndex *index);
+size_t measureRowMemory(Row *row);
+ErrorInfo deleteRowFromTable(Table *table, unsigned int position);
+ErrorInfo deleteColumnFromTable(Table *table, unsigned int columnNumber);
 ErrorInfo alignRowSizes(Table *table);
-void trimRows(Table *table);
+ErrorInfo alignInsertedRow(Table *table, unsigned int position);
+ErrorInfo trimRows(Table *table);
+unsigned int getFilledColumns(Row *row);
 ErrorInfo resizeTable(Table *table, unsigned int rows, unsigned int columns);
+ErrorInfo convertTableToColumns(Table *table);
+ErrorInfo convertTableToRows(Table *table);
+Cell *getColumnCell(Table *table, unsigned int row, unsigned int column);
+unsigned int getTableWidth(Table *table);
+Row *getTableRow(Table *table, unsigned int row);
+unsigned int getRowSlot(Table *table, unsigned int row);
+void moveRowGap(Table *table, unsigned int position);
+void markRowAsModified(Table *table, unsigned int row);
+bool isSavedAsIndexed(Table *table);
+bool isRowSavedAsIndexed(Table *table, unsigned int row);
 void destructTable(Table *table);
 void destructRow(Row *row);
 void destructCell(Cell *cell);
@@ -213,6 +913,9 @@ CommandSequence *createCmdSeq();
 Command *createCmd();
 void addNewCmdToSeq(CommandSequence *cmdSeq, Command *cmd);
 void convertTypesInCommandParams(CommandSequence *cmdSeq);
+unsigned int getUsedColumns(CommandSequence *cmdSeq);
+bool isRowLocal(CommandSequence *cmdSeq);
+bool isColumnCommand(Command *cmd);
 void destructCommandSequence(CommandSequence *cmdSeq);
 void destructCommand(Command *cmd);
 ErrorInfo processCommands(CommandSequence *cmdSeq, Table *table);
@@ -248,6 +951,12 @@ ErrorInfo incVars(Command *cmd, Table *table, Selection *sel, Variables *vars);
 ErrorInfo setVars(Command *cmd, Table *table, Selection *sel, Variables *vars);
 // Help functions
 bool isValidNumber(char *number);
+size_t findStructuralChar(const char *data, size_t size, DelimiterSet *delimiters);
+const char *findIndexedRow(RowIndex *index, unsigned int row);
+#ifdef SIMD_SCANNER
+size_t findStructuralCharSse2(const char *data, size_t size, DelimiterSet *delimiters);
+size_t findStructuralCharAvx2(const char *data, size_t size, DelimiterSet *delimiters);
+#endif
 
 /**
  * The main function
@@ -262,27 +971,74 @@ int main(int argc, char **argv) {
     signed char flag;
 
     /* ARGUMENTS PARSING */
-    // Valid arguments: ./sps [-d DELIMITERS] <CMD_SEQUENCE> <FILE>
+    // Valid arguments: ./sps [-d DELIMITERS] [-i] [-m MEGABYTES] [-c] [--save-binary|--save-text] [--in-place]
+    //                       [-o OUTPUT] <CMD_SEQUENCE> <FILE>
+    // (FILE "-" means reading the standard input and writing the standard output, OUTPUT "-" means writing
+    // the standard output)
+    // (compressed FILE is written back compressed the same way, OUTPUT and the standard output get plain text unless
+    // OUTPUT ends with .gz or .zst, --save-text and --save-binary choose only the format of the table)
     // Check arguments count
     if (argc < 3) {
         writeErrorMessage("Nedostatecny pocet vstupnich argumentu.");
 
         return EXIT_FAILURE;
-    } else if (argc > 5) {
+    } else if (argc > 13) {
         writeErrorMessage("Prekrocen maximalni pocet vstupnich argumentu.");
 
         return EXIT_FAILURE;
     }
 
-    // Get delimiter from arguments
+    // Get options from arguments (see the valid arguments above)
     unsigned int skippedArgs = 1;
-    char **delimiters;
-    if (argc == 5 && streq(argv[skippedArgs], "-d")) {
-        delimiters = &argv[skippedArgs + 1];
-        skippedArgs += 2;
-    } else {
-        const char *DELIMITER = DEFAULT_DELIMITER;
-        delimiters = (char **) &DELIMITER;
+    char *delimiterChars = DEFAULT_DELIMITER;
+    bool useRowIndex = false;
+    size_t memoryLimit = 0;
+    bool compactTable = false;
+    int saveFormat = EMPTY_FLAG;
+    bool patchInPlace = false;
+    char *outputArg = NULL;
+    while (argc - skippedArgs > 2) {
+        if (argc - skippedArgs > 3 && streq(argv[skippedArgs], "-d")) {
+            delimiterChars = argv[skippedArgs + 1];
+            skippedArgs += 2;
+        } else if (argc - skippedArgs > 3 && streq(argv[skippedArgs], "-o")) {
+            outputArg = argv[skippedArgs + 1];
+            skippedArgs += 2;
+        } else if (argc - skippedArgs > 3 && streq(argv[skippedArgs], "-m")) {
+            char *end;
+            unsigned long megabytes = strtoul(argv[skippedArgs + 1], &end, 10);
+            if (*argv[skippedArgs + 1] < '0' || *argv[skippedArgs + 1] > '9' || *end != '\0' || megabytes == 0
+                || megabytes > SIZE_MAX / (1024 * 1024)) {
+                writeErrorMessage("Limit pameti musi byt kladne cele cislo (pocet MiB).");
+
+                return EXIT_FAILURE;
+            }
+
+            memoryLimit = megabytes * 1024 * 1024;
+            skippedArgs += 2;
+        } else if (streq(argv[skippedArgs], "-i")) {
+            useRowIndex = true;
+            skippedArgs += 1;
+        } else if (streq(argv[skippedArgs], "-c")) {
+            compactTable = true;
+            skippedArgs += 1;
+        } else if (streq(argv[skippedArgs], "--save-binary") || streq(argv[skippedArgs], "--save-text")) {
+            saveFormat = (streq(argv[skippedArgs], "--save-binary") ? TABLE_FORMAT_SNAPSHOT : TABLE_FORMAT_TEXT);
+            skippedArgs += 1;
+        } else if (streq(argv[skippedArgs], "--in-place")) {
+            patchInPlace = true;
+            skippedArgs += 1;
+        } else {
+            break;
+        }
+    }
+
+    // Prepare classes of chars for the delimiters (they're used by all of the parsing and saving functions)
+    DelimiterSet *delimiters;
+    if ((delimiters = createDelimiterSet(delimiterChars)) == NULL) {
+        writeErrorMessage("Nepodarilo se alokovat pamet pro oddelovace sloupcu.");
+
+        return EXIT_FAILURE;
     }
 
     // Get commands from arguments
@@ -300,62 +1056,365 @@ int main(int argc, char **argv) {
     }
     skippedArgs += 1;
 
-    // Get file from arguments
+    // Get file from arguments (the table can be read from the standard input and written to the standard output)
     char *inputFile = argv[skippedArgs];
+    char *outputPath = (outputArg != NULL ? outputArg : inputFile);
+    bool standardInput = streq(inputFile, STANDARD_STREAMS_FILE);
+    bool standardOutput = streq(outputPath, STANDARD_STREAMS_FILE);
 
     /* DATA LOADING */
     // Open the file for reading
-    FILE *fileRead;
-    if ((fileRead = fopen(inputFile, "r")) == NULL) {
+    FILE *fileRead = stdin;
+    if (!standardInput && (fileRead = fopen(inputFile, "r")) == NULL) {
         writeErrorMessage("Zadany soubor se nepodarilo otevrit pro cteni.");
 
         return EXIT_FAILURE;
     }
+    struct stat inputInfo;
+    bool regularFile = (fstat(fileno(fileRead), &inputInfo) == 0 && S_ISREG(inputInfo.st_mode));
+
+    // Output into another file than the input one (it's created as a regular file, if it doesn't exist yet)
+    struct stat outputInfo;
+    bool outputExists = (!standardOutput && stat(outputPath, &outputInfo) == 0);
+    bool separateOutput = (standardInput != standardOutput
+                           || (!standardInput && !(outputExists && outputInfo.st_dev == inputInfo.st_dev
+                                                   && outputInfo.st_ino == inputInfo.st_ino)));
+    bool regularOutput = (separateOutput ? !outputExists || S_ISREG(outputInfo.st_mode) : regularFile);
+
+    // Compressed file is read through a decompressing process (gzip or zstd program found in PATH)
+    int compression = detectCompression(fileRead);
+    pid_t decompressor = 0;
+    if (compression != COMPRESSION_NONE) {
+        FILE *compressedFile = fileRead;
+        fileRead = openCompressionFilter(compression, fileno(compressedFile), false, &decompressor);
+        fclose(compressedFile);
+        if (fileRead == NULL) {
+            writeErrorMessage("Vstupni soubor se nepodarilo dekomprimovat.");
+
+            return EXIT_FAILURE;
+        }
+    }
 
-    // Load data from file
-    Table *table;
+    // Compression of the output (written back the same way, other outputs by their extension)
+    int outputCompression = (separateOutput || standardOutput ? getCompressionByName(outputPath) : compression);
+
+    // Row index is used if it's wanted or if the file has been already indexed (it's next to the real file)
+    char *realInputFile = realpath(inputFile, NULL);
+    char *indexFile = NULL;
+    if (!standardInput && compression == COMPRESSION_NONE) {
+        indexFile = getRowIndexPath(realInputFile != NULL ? realInputFile : inputFile);
+    }
+    if (indexFile != NULL && !useRowIndex && access(indexFile, F_OK) != 0) {
+        free(indexFile);
+        indexFile = NULL;
+    }
+    free(realInputFile);
+
+    // Load data from file (mapped or decompressed data are loaded from memory, other ones are read as a stream)
+    Table *table = NULL;
+    size_t mappedSize = 0;
+    size_t mappedCapacity = 0;
+    char *mappedData = NULL;
+    StreamLoading loading;
+    bool loadedWhileRead = (compression != COMPRESSION_NONE && !compactTable && memoryLimit == 0
+                            && (!isRowLocal(cmdSeq) || saveFormat == TABLE_FORMAT_SNAPSHOT));
+    startStreamLoading(&loading, delimiters, getUsedColumns(cmdSeq));
+    if (compression == COMPRESSION_NONE) {
+        mappedData = mapFileToMemory(fileRead, &mappedSize);
+        mappedCapacity = mappedSize;
+    } else if ((err = readStreamToMemory(fileRead, &mappedData, &mappedSize, &mappedCapacity,
+                                         loadedWhileRead ? &loading : NULL)).error
+               || !waitForCompressionFilter(decompressor)) {
+        writeErrorMessage(err.error ? err.message : "Vstupni soubor se nepodarilo dekomprimovat.");
+
+        destructTable(loading.table);
+        if (mappedData != NULL) {
+            munmap(mappedData, mappedCapacity);
+        }
+        fclose(fileRead);
+        return EXIT_FAILURE;
+    }
+    bool snapshot = (mappedData != NULL && isTableSnapshot(mappedData, mappedSize));
+    bool savedAsSnapshot = (saveFormat == EMPTY_FLAG ? snapshot : saveFormat == TABLE_FORMAT_SNAPSHOT);
+    bool streamed = (mappedData != NULL && mappedSize > 0 && !snapshot && !savedAsSnapshot && isRowLocal(cmdSeq));
+    unsigned tableWidth = 0;
+    unsigned filledColumns = 0;
+    RowIndex *index = NULL;
+    PageCache *cache = NULL;
     flag = EMPTY_FLAG;
-    if ((table = loadTableFromFile(fileRead, *delimiters, &flag)) == NULL) {
-        if (flag == INVALID_INPUT_FORMAT) {
+    if (mappedData != NULL && !streamed && !snapshot && memoryLimit > 0
+        && (cache = createPageCache(memoryLimit)) == NULL) {
+        writeErrorMessage("Nepodarilo se alokovat pamet pro strankovani radku.");
+
+        munmap(mappedData, mappedCapacity);
+        fclose(fileRead);
+        return EXIT_FAILURE;
+    }
+    if (streamed) {
+        // Rows are processed while saving, only the width of the processed table is measured
+        if ((err = measureProcessedTable(mappedData, mappedSize, delimiters, cmdSeq, &tableWidth,
+                                         &filledColumns)).error) {
+            writeErrorMessage(err.message);
+
+            munmap(mappedData, mappedCapacity);
+            fclose(fileRead);
+            return EXIT_FAILURE;
+        }
+    } else if (snapshot) {
+        // Cells of the binary snapshot are views into it
+        table = loadTableFromSnapshot(mappedData, mappedSize, delimiters, &flag);
+    } else if (mappedData != NULL && indexFile != NULL
+        && (index = loadRowIndex(indexFile, fileRead, mappedData, mappedSize, delimiters)) != NULL) {
+        // Rows of the indexed file are loaded when they're needed
+        if ((table = loadTableFromIndex(index, cache)) == NULL) {
+            destructRowIndex(index);
+            destructPageCache(cache);
+        }
+    } else if (cache != NULL) {
+        // Least recently used rows are evicted over the memory limit
+        if ((index = buildRowIndex(mappedData, mappedSize, delimiters, &flag)) == NULL
+            || (table = loadTableFromIndex(index, cache)) == NULL) {
+            destructRowIndex(index);
+            destructPageCache(cache);
+        }
+    } else if (mappedData != NULL && loadedWhileRead) {
+        // Table has been loaded by chunks while the data were decompressed
+        table = loading.table;
+        flag = loading.flag;
+    } else if (mappedData != NULL) {
+        // Cells are views into the mapped data, only the used columns are loaded
+        table = loadTableFromMemory(mappedData, mappedSize, delimiters, getUsedColumns(cmdSeq), compactTable, &flag);
+    } else {
+        table = loadTableFromFile(fileRead, delimiters, &flag);
+    }
+    if (table == NULL && !streamed) {
+        if (flag == INVALID_INPUT_FORMAT && snapshot) {
+            writeErrorMessage("Vstupni soubor obsahuje poskozeny binarni snimek tabulky.");
+        } else if (flag == INVALID_INPUT_FORMAT) {
             writeErrorMessage("Vstupni soubor obsahuje bunku v chybnem formatu.");
         } else {
             writeErrorMessage("Nepodarilo se nacist tabulku z duvodu chyby pri alokaci pameti.");
         }
 
         destructTable(table);
+        if (mappedData != NULL) {
+            munmap(mappedData, mappedCapacity);
+        }
         fclose(fileRead);
         return EXIT_FAILURE;
     }
 
-    // Close the read file
+    // Close the read file (the mapped one stays open for copying its unchanged parts by the kernel)
+    int originalDescriptor = (compression == COMPRESSION_NONE && mappedData != NULL ? dup(fileno(fileRead)) : -1);
     fclose(fileRead);
 
     /* DATA PARSING */
-    if ((err = processCommands(cmdSeq, table)).error) {
+    if (!streamed && (err = processCommands(cmdSeq, table)).error) {
         writeErrorMessage(err.message);
 
         return EXIT_FAILURE;
     }
 
-    /* HELP DATA DEALLOCATION */
-    // Commands
-    destructCommandSequence(cmdSeq);
-
     /* OUTPUT SAVING */
-    // Open the file for writing
-    FILE *fileWrite;
-    if ((fileWrite = fopen(inputFile, "w")) == NULL) {
+    // Table which would be saved exactly as its loaded data isn't saved at all
+    bool unchanged = (!streamed && !standardOutput && !separateOutput && savedAsSnapshot == snapshot
+                      && (snapshot ? table->modifiedRow == NOT_MODIFIED_ROW : isSavedAsIndexed(table)));
+
+    // Open the file for writing (regular file is replaced by a new one after saving)
+    FILE *fileWrite = NULL;
+    char *outputFile = NULL;
+    char *replacementFile = NULL;
+    DeferredOutput deferred = {.path = NULL, .file = NULL, .replacementPath = NULL, .stream = NULL, .compressor = 0};
+    if (standardOutput) {
+        fileWrite = stdout;
+    } else if (!unchanged && !regularOutput) {
+        fileWrite = fopen(outputPath, "w");
+    } else if (!unchanged && ((outputFile = realpath(outputPath, NULL)) != NULL
+                              || (separateOutput && (outputFile = strdup(outputPath)) != NULL))) {
+        if (!separateOutput && outputCompression != COMPRESSION_NONE && mappedData != NULL) {
+            // Compressed file is opened only when the output differs from its decompressed data
+            deferred.path = outputFile;
+            deferred.compression = outputCompression;
+        } else {
+            fileWrite = openReplacementFile(outputFile, &replacementFile);
+        }
+    }
+    if (!unchanged && fileWrite == NULL && deferred.path == NULL) {
         writeErrorMessage("Zadany soubor se nepodarilo otevrit pro zapis.");
 
+        free(outputFile);
         return EXIT_FAILURE;
     }
 
-    // Write output to the file
-    saveTableToFile(table, fileWrite, *delimiters);
+    // Compressed output is written through a compressing process (SIGPIPE is ignored while it runs)
+    FILE *outputStream = fileWrite;
+    pid_t compressor = 0;
+    void (*pipeHandler)(int) = SIG_DFL;
+    if (!unchanged && outputCompression != COMPRESSION_NONE && deferred.path == NULL) {
+        pipeHandler = signal(SIGPIPE, SIG_IGN);
+        if ((outputStream = openCompressionFilter(outputCompression, fileno(fileWrite), true, &compressor)) == NULL) {
+            writeErrorMessage("Zadany soubor se nepodarilo otevrit pro zapis.");
+
+            signal(SIGPIPE, pipeHandler);
+            fclose(fileWrite);
+            if (replacementFile != NULL) {
+                unlink(replacementFile);
+            }
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Write output to the file (it's compared with the loaded data, new row index is built while saving)
+    char *outputIndexFile = indexFile;
+    if (separateOutput) {
+        outputIndexFile = NULL;
+        char *realOutputFile = realpath(outputPath, NULL);
+        if (!standardOutput && outputCompression == COMPRESSION_NONE) {
+            outputIndexFile = getRowIndexPath(realOutputFile != NULL ? realOutputFile : outputPath);
+        }
+        if (outputIndexFile != NULL && !useRowIndex && access(outputIndexFile, F_OK) != 0) {
+            free(outputIndexFile);
+            outputIndexFile = NULL;
+        }
+        free(realOutputFile);
+    }
+    RowIndex *newIndex = NULL;
+    if (unchanged && indexFile != NULL) {
+        newIndex = table->index;
+        table->index = NULL;
+    } else if (!unchanged) {
+        OutputBuffer *output;
+        bool compared = (!standardOutput && outputCompression == compression
+                         && (compression == COMPRESSION_NONE || deferred.path != NULL));
+        int patchDescriptor = -1;
+        if (patchInPlace && compared && !separateOutput && mappedData != NULL && replacementFile != NULL) {
+            patchDescriptor = open(outputFile, O_WRONLY);
+        }
+        if ((outputIndexFile != NULL && !savedAsSnapshot && (newIndex = createRowIndex(delimiters)) == NULL)
+            || (output = createOutputBuffer(outputStream, compared ? mappedData : NULL, mappedSize, patchDescriptor,
+                                            compared ? originalDescriptor : -1, separateOutput,
+                                            deferred.path != NULL ? &deferred : NULL)) == NULL) {
+            writeErrorMessage("Nepodarilo se alokovat pamet pro zapis tabulky.");
+
+            if (compressor != 0) {
+                closeCompressionFilter(outputStream, compressor);
+                signal(SIGPIPE, pipeHandler);
+            }
+            if (fileWrite != NULL) {
+                fclose(fileWrite);
+            }
+            if (patchDescriptor != -1) {
+                close(patchDescriptor);
+            }
+            if (replacementFile != NULL) {
+                unlink(replacementFile);
+            }
+            return EXIT_FAILURE;
+        }
+
+        if (streamed) {
+            err = streamTableToFile(mappedData, mappedSize, delimiters, cmdSeq, tableWidth, filledColumns, output,
+                                    newIndex);
+        } else if (savedAsSnapshot) {
+            err = saveTableToSnapshot(table, output);
+        } else {
+            err = saveTableToFile(table, output, delimiters, newIndex);
+        }
+        if (!err.error) {
+            err = finishOutput(output);
+        }
+        unchanged = !output->changed;
+        destructOutputBuffer(output);
+        if (patchDescriptor != -1) {
+            close(patchDescriptor);
+        }
+        if (originalDescriptor != -1) {
+            close(originalDescriptor);
+        }
+
+        // Deferred output file which has been opened is finished the same way as the other ones
+        if (deferred.file != NULL) {
+            fileWrite = deferred.file;
+            replacementFile = deferred.replacementPath;
+            outputStream = deferred.stream;
+            compressor = deferred.compressor;
+            pipeHandler = deferred.pipeHandler;
+        }
+
+        // Compressing process must write all of the data before the file is synced
+        if (compressor != 0 && !closeCompressionFilter(outputStream, compressor) && !err.error) {
+            err.error = true;
+            err.message = "Vystupni data se nepodarilo zkomprimovat.";
+        }
+        if (compressor != 0) {
+            signal(SIGPIPE, pipeHandler);
+        }
+
+        // The new file must be on the disk before it replaces the original one
+        if (!err.error && !unchanged && replacementFile != NULL && fsync(fileno(fileWrite)) != 0) {
+            err.error = true;
+            err.message = "Zadany soubor se nepodarilo ulozit na disk.";
+        }
+        if (err.error) {
+            writeErrorMessage(err.message);
+
+            if (fileWrite != NULL) {
+                fclose(fileWrite);
+            }
+            if (replacementFile != NULL) {
+                unlink(replacementFile);
+            }
+            return EXIT_FAILURE;
+        }
+    }
 
-    // Deallocate table and close the write file
+    /* HELP DATA DEALLOCATION */
+    // Commands, table and the write file
+    destructCommandSequence(cmdSeq);
     destructTable(table);
-    fclose(fileWrite);
+    if (fileWrite != NULL && fclose(fileWrite) != 0 && !unchanged) {
+        writeErrorMessage("Zadany soubor se nepodarilo ulozit na disk.");
+
+        if (replacementFile != NULL) {
+            unlink(replacementFile);
+        }
+        return EXIT_FAILURE;
+    }
+
+    // Replace the original file by the new one (the same output is thrown away)
+    if (mappedData != NULL) {
+        munmap(mappedData, mappedCapacity);
+    }
+    if (replacementFile != NULL && unchanged) {
+        unlink(replacementFile);
+    } else if (replacementFile != NULL) {
+        if (rename(replacementFile, outputFile) != 0) {
+            writeErrorMessage("Zadany soubor se nepodarilo nahradit novymi daty.");
+
+            unlink(replacementFile);
+            free(replacementFile);
+            free(outputFile);
+            free(indexFile);
+            return EXIT_FAILURE;
+        }
+
+        syncParentDirectory(outputFile);
+    }
+    free(replacementFile);
+
+    // Rebuild row index of the saved file (snapshot has no row index)
+    if (newIndex != NULL) {
+        saveRowIndex(newIndex, outputIndexFile, outputFile != NULL ? outputFile : outputPath);
+    } else if (outputIndexFile != NULL && savedAsSnapshot) {
+        unlink(outputIndexFile);
+    }
+    destructRowIndex(newIndex);
+    destructDelimiterSet(delimiters);
+    if (outputIndexFile != indexFile) {
+        free(outputIndexFile);
+    }
+    free(indexFile);
+    free(outputFile);
 
     return EXIT_SUCCESS;
 }
@@ -367,10 +1426,14 @@ int main(int argc, char **argv) {
  * @param delimiters Column delimiters
  * @return Loaded table
  */
-Table *loadTableFromFile(FILE *file, char *delimiters, signed char *flag) {
-    // Prepare new table
+Table *loadTableFromFile(FILE *file, DelimiterSet *delimiters, signed char *flag) {
+    // Prepare new table (its cells are allocated from its arena)
     Table *table;
-    if ((table = createTable()) == NULL) {
+    if ((table = createTable(TABLE_START_CAPACITY, delimiters)) == NULL) {
+        return NULL;
+    }
+    if ((table->arena = createArena()) == NULL) {
+        destructTable(table);
         return NULL;
     }
 
@@ -378,7 +1441,7 @@ Table *loadTableFromFile(FILE *file, char *delimiters, signed char *flag) {
     while (*flag != LAST_ROW) {
         // Get the row data
         Row *row;
-        if ((row = loadRowFromFile(file, delimiters, flag)) == NULL) {
+        if ((row = loadRowFromFile(file, delimiters, table->arena, flag)) == NULL) {
             return NULL;
         }
 
@@ -400,13 +1463,14 @@ Table *loadTableFromFile(FILE *file, char *delimiters, signed char *flag) {
  * Constructs row with data from a file
  * @param file The file with data for the row
  * @param delimiters Column delimiters
+ * @param arena Arena for the cells (NULL if each cell is allocated separately)
  * @param flag Flag for returning special states
  * @return Loaded row
  */
-Row *loadRowFromFile(FILE *file, char *delimiters, signed char *flag) {
+Row *loadRowFromFile(FILE *file, DelimiterSet *delimiters, Arena *arena, signed char *flag) {
     // Prepare new row
     Row *row;
-    if ((row = createRow()) == NULL) {
+    if ((row = createRow(ROW_START_CAPACITY)) == NULL) {
         return NULL;
     }
 
@@ -414,7 +1478,7 @@ Row *loadRowFromFile(FILE *file, char *delimiters, signed char *flag) {
     while (*flag != LAST_ROW && *flag != LAST_CELL) {
         // Get the cell data
         Cell *cell;
-        if ((cell = loadCellFromFile(file, delimiters, flag)) == NULL) {
+        if ((cell = loadCellFromFile(file, delimiters, arena, flag)) == NULL) {
             return NULL;
         }
 
@@ -435,13 +1499,14 @@ Row *loadRowFromFile(FILE *file, char *delimiters, signed char *flag) {
  * Constructs cell with data from a file
  * @param file The file with data for the row
  * @param delimiters Column delimiters
+ * @param arena Arena for the cell (NULL if the cell is allocated separately)
  * @param flag Flag for returning special states
  * @return Loaded cell
  */
-Cell *loadCellFromFile(FILE *file, char *delimiters, signed char *flag) {
+Cell *loadCellFromFile(FILE *file, DelimiterSet *delimiters, Arena *arena, signed char *flag) {
     // Prepare the cell
     Cell *cell;
-    if ((cell = createCell()) == NULL) {
+    if ((cell = createCell(arena)) == NULL) {
         return NULL;
     }
 
@@ -449,7 +1514,7 @@ Cell *loadCellFromFile(FILE *file, char *delimiters, signed char *flag) {
     int prevC = '\0'; // Previous loaded char
     int c; // Loaded char
     bool ignoreDelimiters = false;
-    while ((c = getc(file)) != EOF && c != '\n' && (!strc(delimiters, c) || ignoreDelimiters)) {
+    while ((c = getc(file)) != EOF && c != '\n' && (!isDelimiter(delimiters, c) || ignoreDelimiters)) {
         if (c == '"' && prevC != '\\') {
             // Border char at the start of the cell
             if (prevC == '\0') {
@@ -457,7 +1522,7 @@ Cell *loadCellFromFile(FILE *file, char *delimiters, signed char *flag) {
             } else {
                 // At the first position has been border char and it's the last char of the cell
                 int nextC;
-                if (((nextC = getc(file)) == '\n' || strc(delimiters, nextC)) && ignoreDelimiters) {
+                if (((nextC = getc(file)) == '\n' || isDelimiter(delimiters, nextC)) && ignoreDelimiters) {
                     // Next delimiter will end the cell
                     ignoreDelimiters = false;
                 } else {
@@ -467,8 +1532,9 @@ Cell *loadCellFromFile(FILE *file, char *delimiters, signed char *flag) {
                 }
                 ungetc(nextC, file); // Put the char back to the scope
             }
-        } else if (!strc(SPECIAL_CHARS, c) || prevC == '\\'){
+        } else if (!isSpecialChar(delimiters, c) || prevC == '\\'){
             addCharToCell(cell, (char)c, cell->size + 1);
+            cell->flags |= getCharFlags(delimiters, c);
         }
 
         prevC = c;
@@ -495,577 +1561,4892 @@ Cell *loadCellFromFile(FILE *file, char *delimiters, signed char *flag) {
 }
 
 /**
- * Loads commands from string into command sequence
- * @param string String with commands
- * @param flag Flag for returning additional information
- * @return Command sequence with loaded commands
+ * Constructs table with data from a memory buffer (for ex. file mapped into memory)
+ * Data are loaded in two passes. The first one only counts rows and cells, so the second one can allocate the table
+ * and its rows with the final sizes. Big buffers are split into chunks of whole rows and the chunks are processed
+ * in parallel.
+ * @param data Buffer with data for the table
+ * @param size Size of the buffer
+ * @param delimiters Column delimiters
+ * @param columns Number of cells to load in each row (the other ones are only checked and kept as raw data)
+ * @param compact Should the rows be loaded as compact? (all of the cells are decoded into one heap, their cells are
+ *                created only for changed rows), data bigger than offsets of the heap can address are loaded normally
+ * @param flag Flag for returning special states
+ * @return Loaded table
  */
-CommandSequence *loadCommandsFromString(const char *string, signed char *flag) {
-    CommandSequence *cmdSeq;
-    if ((cmdSeq = createCmdSeq()) == NULL) {
+Table *loadTableFromMemory(const char *data, size_t size, DelimiterSet *delimiters, unsigned int columns,
+                           bool compact, signed char *flag) {
+    // Measure chunks of data (numbers of rows and cells in the widest rows)
+    LoadingChunk chunks[MAX_LOADING_THREADS];
+    unsigned chunksCount = splitIntoLoadingChunks(data, size, delimiters, chunks);
+    processChunksInParallel(measureChunk, chunks, sizeof(LoadingChunk), chunksCount);
+
+    unsigned rowsCount = 0;
+    unsigned width = 0;
+    for (unsigned i = 0; i < chunksCount; i++) {
+        rowsCount += chunks[i].capacity;
+
+        if (chunks[i].width > width) {
+            width = chunks[i].width;
+        }
+    }
+
+    // Prepare new table with space for all of the rows (its cells are allocated from its arena)
+    Table *table;
+    if ((table = createTable(rowsCount > 0 ? rowsCount : TABLE_START_CAPACITY, delimiters)) == NULL) {
+        return NULL;
+    }
+    if ((table->arena = createArena()) == NULL) {
+        destructTable(table);
         return NULL;
     }
 
-    // Prepare first command
-    Command *cmd;
-    if ((cmd = createCmd()) == NULL) {
+    // Contents of cells of the compact rows aren't longer than their raw data and each one is ended by '\0' instead of
+    // the delimiter or the line break, which ends its raw data (only the last cell of each chunk can be without it)
+    if (compact && size + chunksCount <= UINT32_MAX && (table->heap = malloc(size + chunksCount)) == NULL) {
+        destructTable(table);
         return NULL;
     }
 
-    // Parse string to commands
-    unsigned i, cmdI, paramI;
-    for (i = cmdI = paramI = 0; i < strlen(string); i++) {
-        if (string[i] == ';') {
-            // Close the command
-            addNewCmdToSeq(cmdSeq, cmd);
+    // Each chunk loads its rows right into its part of the table, rows are created with space for all of the cells
+    // which are loaded (compact rows with space for all of the cells of the widest row)
+    // Chunks allocate their cells from their own arenas (threads don't share them), they're merged into the table's one
+    unsigned rowCapacity = (width < columns ? width : columns);
+    bool success = true;
+    rowsCount = 0;
+    for (unsigned i = 0; i < chunksCount; i++) {
+        chunks[i].rows = &(table->rows[rowsCount]);
+        chunks[i].width = (table->heap != NULL ? width : rowCapacity);
+        chunks[i].width = (chunks[i].width > 0 ? chunks[i].width : 1);
+        chunks[i].columns = columns;
+        chunks[i].heap = table->heap;
+        chunks[i].heapOffset = (uint32_t)(chunks[i].start - data) + i;
+        if ((chunks[i].arena = createArena()) == NULL) {
+            success = false;
+        }
+        rowsCount += chunks[i].capacity;
+    }
 
-            // Prepare the next command
-            cmdI = 0;
-            paramI = 0;
-            if ((cmd = createCmd()) == NULL) {
-                return NULL;
+    if (success) {
+        processChunksInParallel(loadChunkFromMemory, chunks, sizeof(LoadingChunk), chunksCount);
+
+        // The first unsuccessful chunk determines the result (the same error would be found by loading row by row)
+        for (unsigned i = 0; i < chunksCount; i++) {
+            if (success && chunks[i].flag != LAST_ROW) {
+                *flag = chunks[i].flag;
+                success = false;
             }
-        } else if(string[i] == ' ' && string[i - 1] != '\\') {
-            // Move to the next parameter
-            paramI++;
-            // Reset parameter string iteration var
-            cmdI = 0;
+        }
+    } else {
+        // Nothing has been loaded
+        for (unsigned i = 0; i < chunksCount; i++) {
+            chunks[i].size = 0;
+        }
+    }
+
+    if (!success) {
+        // Only loaded rows are destructed (rows of the chunks aren't in one piece)
+        for (unsigned i = 0; i < chunksCount; i++) {
+            for (unsigned j = 0; j < chunks[i].size; j++) {
+                destructRow(chunks[i].rows[j]);
+            }
+            destructArena(chunks[i].arena);
+        }
+        destructTable(table);
+
+        return NULL;
+    }
+
+    for (unsigned i = 0; i < chunksCount; i++) {
+        mergeArenas(table->arena, chunks[i].arena);
+    }
+
+    table->size = rowsCount;
+    *flag = LAST_ROW;
+
+    // Align rows to the same number of columns
+    if (alignRowSizes(table).error) {
+        destructTable(table);
+        return NULL;
+    }
+
+    return table;
+}
+
+/**
+ * Constructs row with data from a memory buffer
+ * @param position Actual position in the buffer (it's moved behind the loaded row)
+ * @param end End of the buffer (the first byte behind)
+ * @param delimiters Column delimiters
+ * @param capacity Expected number of cells in the row (at least 1)
+ * @param columns Number of cells to load (the other ones are only checked and kept as the raw tail of the row)
+ * @param arena Arena for the cells (NULL if each cell is allocated separately)
+ * @param flag Flag for returning special states
+ * @return Loaded row
+ */
+Row *loadRowFromMemory(const char **position, const char *end, DelimiterSet *delimiters, unsigned int capacity,
+                       unsigned int columns, Arena *arena, signed char *flag) {
+    // Prepare new row
+    Row *row;
+    if ((row = createRow(capacity)) == NULL) {
+        return NULL;
+    }
+
+    // Load row data
+    while (*flag != LAST_ROW && *flag != LAST_CELL) {
+        // Cells behind the loaded columns stay in the raw data
+        if (row->size >= columns) {
+            if (!scanRowTailFromMemory(row, position, end, delimiters, flag)) {
+                destructRow(row);
+                return NULL;
+            }
+
+            break;
+        }
+
+        // Get the cell data
+        Cell *cell;
+        if ((cell = loadCellFromMemory(position, end, delimiters, arena, flag)) == NULL) {
+            destructRow(row);
+            return NULL;
+        }
+
+        // Add the cell to the end of the row (row->size == last index + 1)
+        if ((addCellToRow(row, cell, row->size + 1)).error) {
+            destructCell(cell);
+            destructRow(row);
+            return NULL;
+        }
+    }
+
+    if (*flag == LAST_CELL) {
+        *flag = EMPTY_FLAG;
+    }
+
+    return row;
+}
+
+/**
+ * Constructs compact row with data from a memory buffer
+ * Cells are checked the same way as loadRowFromMemory() checks them, their contents are decoded into the heap.
+ * @param position Actual position in the buffer (it's moved behind the loaded row)
+ * @param end End of the buffer (the first byte behind)
+ * @param delimiters Column delimiters
+ * @param capacity Max number of cells in the row (at least 1)
+ * @param heap Heap for contents of the cells
+ * @param heapOffset Offset of free space in the heap (it's moved behind contents of the loaded cells)
+ * @param flag Flag for returning special states
+ * @return Loaded row
+ */
+Row *loadCompactRowFromMemory(const char **position, const char *end, DelimiterSet *delimiters, unsigned int capacity,
+                              char *heap, uint32_t *heapOffset, signed char *flag) {
+    // Prepare new row
+    Row *row;
+    if ((row = createCompactRow(heap, delimiters, capacity)) == NULL) {
+        return NULL;
+    }
+
+    // Load row data
+    while (*flag != LAST_ROW && *flag != LAST_CELL) {
+        // Measured number of cells can't be exceeded (the row can't be resized)
+        Cell cell = {.content.allocated.data = NULL, .raw = NULL, .size = 0, .rawSize = 0, .flags = 0};
+        if (row->size >= capacity || !scanCellFromMemory(position, end, delimiters, &cell, flag)) {
+            destructRow(row);
+            return NULL;
+        }
+
+        copyCellContent(&cell, heap + *heapOffset);
+        heap[*heapOffset + cell.size] = '\0';
+        row->spans[row->size].offset = *heapOffset;
+        row->spans[row->size].size = cell.size;
+        row->size++;
+        *heapOffset += cell.size + 1;
+    }
+
+    if (*flag == LAST_CELL) {
+        *flag = EMPTY_FLAG;
+    }
+
+    return row;
+}
+
+/**
+ * Constructs cell with data from a memory buffer
+ * It works the same way as loadCellFromFile(), only the source of chars is different
+ * @param position Actual position in the buffer (it's moved behind the loaded cell)
+ * @param end End of the buffer (the first byte behind)
+ * @param delimiters Column delimiters
+ * @param arena Arena for the cell (NULL if the cell is allocated separately)
+ * @param flag Flag for returning special states
+ * @return Loaded cell
+ */
+Cell *loadCellFromMemory(const char **position, const char *end, DelimiterSet *delimiters, Arena *arena,
+                         signed char *flag) {
+    // Prepare the cell (it will be only a view into the buffer, its content is copied out when it's needed)
+    Cell *cell;
+    if ((cell = createCell(arena)) == NULL) {
+        return NULL;
+    }
+
+    if (!scanCellFromMemory(position, end, delimiters, cell, flag)) {
+        destructCell(cell);
+        return NULL;
+    }
+
+    return cell;
+}
+
+/**
+ * Scans a cell in a memory buffer (checks its format and measures its content)
+ * @param position Actual position in the buffer (it's moved behind the scanned cell)
+ * @param end End of the buffer (the first byte behind)
+ * @param delimiters Column delimiters
+ * @param cell Empty cell to fill with information about the scanned one (it becomes a view into the buffer)
+ * @param flag Flag for returning special states
+ * @return Has the cell valid format?
+ */
+bool scanCellFromMemory(const char **position, const char *end, DelimiterSet *delimiters, Cell *cell,
+                        signed char *flag) {
+    // Load data from buffer
+    const char *pos = *position;
+    int prevC = '\0'; // Previous loaded char
+    int c; // Loaded char
+    bool ignoreDelimiters = false;
+    while (true) {
+        // Span of ordinary chars (without delimiters, line breaks and special chars) is skipped at once
+        size_t span;
+        if ((span = findStructuralChar(pos, (size_t)(end - pos), delimiters)) > 0) {
+            cell->size += (unsigned)span;
+            prevC = (unsigned char)pos[span - 1];
+            pos += span;
+        }
+
+        // Structural char is processed separately (the cell can end here)
+        if ((c = getcFromMemory(pos, end)) == EOF || c == '\n' || (isDelimiter(delimiters, c) && !ignoreDelimiters)) {
+            break;
+        }
+
+        if (c == '"' && prevC != '\\') {
+            cell->flags |= CELL_RAW_ENCODED;
+
+            // Border char at the start of the cell
+            if (prevC == '\0') {
+                ignoreDelimiters = true;
+            } else {
+                // At the first position has been border char and it's the last char of the cell
+                int nextC = (pos < end ? (unsigned char)*pos : EOF); // Only look at the next char
+                if ((nextC == '\n' || isDelimiter(delimiters, nextC)) && ignoreDelimiters) {
+                    // Next delimiter will end the cell
+                    ignoreDelimiters = false;
+                } else {
+                    *flag = INVALID_INPUT_FORMAT;
+
+                    return false;
+                }
+            }
+        } else if (!isSpecialChar(delimiters, c) || prevC == '\\'){
+            cell->size++;
+            cell->flags |= getCharFlags(delimiters, c);
         } else {
-            // Selection commands: [R, C], [R1,C1,R2,C2], [_] and [_,_]
-            if (cmdI == 0 && string[i] == '[' && (isdigit(string[i + 1]) || string[i + 1] == '_')) {
-                // Skip the '[' char
-                i++;
+            // Escape char isn't a part of the content
+            cell->flags |= CELL_RAW_ENCODED;
+        }
 
-                // Set the name for selection commands
-                // Classic commands has already had name, so only process selection contains in its parameter
-                if (paramI == 0) {
-                    // Set a type and a name (this type of commands doesn't have a name in input string)
-                    cmd->type = SELECTION_COMMAND;
-                    memcpy(cmd->name, "select", 7);
-                    paramI = 1;
+        prevC = c;
+    }
+
+    // The cell doesn't have end border char
+    if (ignoreDelimiters) {
+        *flag = INVALID_INPUT_FORMAT;
+
+        return false;
+    }
+
+    // Detect the last row and the last cell (by cause of the while end)
+    if (c == '\n') {
+        *flag = LAST_CELL;
+    }
+
+    if (pos >= end) {
+        *flag = LAST_ROW;
+    }
+
+    // Raw data of the cell are all of the loaded chars except the one which has ended the cell
+    cell->raw = *position;
+    cell->rawSize = (unsigned)((c == EOF ? pos : pos - 1) - *position);
+    *position = pos;
+
+    return true;
+}
+
+
+/**
+ * Scans the rest of the row in a memory buffer and keeps it as the raw tail of the row
+ * Cells of the tail are checked and counted the same way as they would be loaded, but they aren't created.
+ * @param row Row to add the tail to
+ * @param position Actual position in the buffer (it's moved behind the row)
+ * @param end End of the buffer (the first byte behind)
+ * @param delimiters Column delimiters
+ * @param flag Flag for returning special states
+ * @return Has the tail valid format?
+ */
+bool scanRowTailFromMemory(Row *row, const char **position, const char *end, DelimiterSet *delimiters,
+                           signed char *flag) {
+    row->tail = *position;
+    row->tailFilled = 0;
+    row->tailCanonical = true;
+    row->tailDelimiters = delimiters;
+
+    while (*flag != LAST_ROW && *flag != LAST_CELL) {
+        Cell cell = {.content.allocated.data = NULL, .raw = NULL, .size = 0, .rawSize = 0, .flags = 0};
+        if (!scanCellFromMemory(position, end, delimiters, &cell, flag)) {
+            return false;
+        }
+
+        row->size++;
+        if (cell.size != 0) {
+            row->tailFilled = row->size;
+        }
+
+        // Only the main delimiter and cells without borders and escape chars are saved the same way
+        if ((cell.flags & CELL_RAW_ENCODED) || (*flag == EMPTY_FLAG && (*position)[-1] != delimiters->chars[0])) {
+            row->tailCanonical = false;
+        }
+    }
+
+    // The row without line break at its end (the last row of the data) is saved with it
+    row->tailSize = (unsigned)(*position - row->tail);
+    if (row->tailSize == 0 || row->tail[row->tailSize - 1] != '\n') {
+        row->tailCanonical = false;
+    }
+
+    return true;
+}
+
+/**
+ * Measures a chunk of input data (counts its rows and cells in the widest row)
+ * Cells are counted by the same rules as loadCellFromMemory() uses, only without checking the format of the data.
+ * It's designed to be run in a separate thread (it works only with data of the chunk).
+ * @param chunk Chunk to measure (type LoadingChunk *)
+ * @return Always NULL (result is saved into the chunk)
+ */
+void *measureChunk(void *chunk) {
+    LoadingChunk *data = chunk;
+
+    const char *position = data->start;
+    unsigned cells = 1; // Number of cells in the actual row
+    int prevC = '\0'; // Previous char of the actual cell
+    bool ignoreDelimiters = false;
+    data->capacity = 0;
+    data->width = 0;
+    while (position < data->end) {
+        // Span of ordinary chars can't change anything
+        size_t span;
+        if ((span = findStructuralChar(position, (size_t)(data->end - position), data->delimiters)) > 0) {
+            prevC = (unsigned char)position[span - 1];
+            position += span;
+
+            continue;
+        }
+
+        int c = (unsigned char)*position++;
+        if (c == '\n') {
+            // Line break always ends the row
+            data->capacity++;
+            if (cells > data->width) {
+                data->width = cells;
+            }
+
+            cells = 1;
+            prevC = '\0';
+            ignoreDelimiters = false;
+        } else if (isDelimiter(data->delimiters, c) && !ignoreDelimiters) {
+            // Delimiter at the end of data doesn't start a new cell
+            if (position < data->end) {
+                cells++;
+            }
+
+            prevC = '\0';
+        } else {
+            if (c == '"' && prevC != '\\') {
+                if (prevC == '\0') {
+                    ignoreDelimiters = true;
+                } else if (position >= data->end || *position == '\n' || isDelimiter(data->delimiters, *position)) {
+                    ignoreDelimiters = false;
                 }
+            }
 
-                // Load parameters
-                while (string[i] != ']' && string[i] != ';') {
-                    if (string[i] == ',') {
-                        // Move to the next parameter
-                        paramI++;
-                        // Reset parameter string iteration var
-                        cmdI = 0;
-                    } else {
-                        // Resize string parameters to cmd + 2 for the saving of the next char
-                        // cmd + 2: indexing from 0 and space for '\0'
-                        // [0] => name, [1] => firstParameter --> -1 (array with parameters start at index 0)
-                        char **param = &(cmd->strParams[paramI - 1]);
-                        char *tmp;
-                        if ((tmp = realloc(*param, sizeof(char) * (cmdI + 2))) == NULL) {
-                            return NULL;
-                        } else {
-                            *param = tmp;
-                        }
+            prevC = c;
+        }
+    }
+
+    // The last row doesn't have to end with line break
+    if (data->end > data->start && data->end[-1] != '\n') {
+        data->capacity++;
+        if (cells > data->width) {
+            data->width = cells;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Loads rows from a chunk of input data
+ * It's designed to be run in a separate thread (it works only with data of the chunk)
+ * <strong>Warning! The chunk must be already measured using measureChunk()</strong>
+ * @param chunk Chunk to load (type LoadingChunk *)
+ * @return Always NULL (result is saved into the chunk)
+ */
+void *loadChunkFromMemory(void *chunk) {
+    LoadingChunk *data = chunk;
+
+    // Load rows until the end of the chunk
+    const char *position = data->start;
+    data->flag = EMPTY_FLAG;
+    while (data->flag != LAST_ROW) {
+        // Measured number of rows can't be exceeded (the array with rows is already allocated)
+        if (data->size >= data->capacity) {
+            data->flag = EMPTY_FLAG;
+
+            return NULL;
+        }
+
+        // Get the row data
+        Row *row;
+        if (data->heap != NULL) {
+            row = loadCompactRowFromMemory(&position, data->end, data->delimiters, data->width, data->heap,
+                                           &(data->heapOffset), &(data->flag));
+        } else {
+            row = loadRowFromMemory(&position, data->end, data->delimiters, data->width, data->columns, data->arena,
+                                    &(data->flag));
+        }
+        if (row == NULL) {
+            return NULL;
+        }
+
+        // Add the row at the end of the chunk
+        data->rows[data->size] = row;
+        data->size++;
+    }
+
+    return NULL;
+}
+
+/**
+ * Loads rows from a chunk of input data one by one, applies commands on each of them and measures the result
+ * Rows aren't kept in memory, only the most filled columns of the processed rows are saved into the chunk. Failed
+ * commands don't stop checking the format of the rest of the chunk (invalid input is reported before them).
+ * It's designed to be run in a separate thread (it works only with data of the chunk)
+ * <strong>Warning! The commands must be row-local (see isRowLocal())</strong>
+ * @param chunk Chunk to process (type LoadingChunk *), its width is the number of cells in the widest row of the table
+ * @return Always NULL (result is saved into the chunk)
+ */
+void *measureProcessedChunk(void *chunk) {
+    LoadingChunk *data = chunk;
+
+    // Each row is processed as a single-row table
+    Table *table;
+    if ((table = createTable(TABLE_START_CAPACITY, data->delimiters)) == NULL) {
+        data->flag = EMPTY_FLAG;
+
+        return NULL;
+    }
+
+    const char *position = data->start;
+    unsigned rowCapacity = (data->width < data->columns ? data->width : data->columns);
+    data->filled = 0;
+    data->flag = EMPTY_FLAG;
+    while (data->flag != LAST_ROW) {
+        // Get the row data
+        Row *row;
+        if ((row = loadRowFromMemory(&position, data->end, data->delimiters, (rowCapacity > 0 ? rowCapacity : 1),
+                                     data->columns, NULL, &(data->flag))) == NULL) {
+            break;
+        }
+
+        // Only the format of the rest of rows is checked, if the commands have already failed
+        table->rows[0] = row;
+        table->size = 1;
+        if (data->message == NULL) {
+            ErrorInfo err;
+            if ((err = resizeTable(table, 1, data->width)).error
+                || (err = processCommands(data->commands, table)).error) {
+                data->message = err.message;
+            } else if (getFilledColumns(row) > data->filled) {
+                data->filled = getFilledColumns(row);
+            }
+        }
+
+        destructRow(row);
+        table->size = 0;
+    }
+
+    destructTable(table);
+
+    return NULL;
+}
+
+/**
+ * Measures a chunk of a stream and loads its rows into the chunk's own array of rows
+ * It's designed to be run in a separate thread (it works only with data of the chunk)
+ * @param chunk Chunk to load (type LoadingChunk *)
+ * @return Always NULL (result is saved into the chunk)
+ */
+void *measureAndLoadChunk(void *chunk) {
+    LoadingChunk *data = chunk;
+
+    // Rows are created with space for cells of the widest row of the chunk (other chunks can have wider rows, rows are
+    // aligned in the whole table)
+    measureChunk(data);
+    unsigned rowCapacity = (data->width < data->columns ? data->width : data->columns);
+    data->width = (rowCapacity > 0 ? rowCapacity : 1);
+    if ((data->rows = malloc(data->capacity * sizeof(Row *))) == NULL || (data->arena = createArena()) == NULL) {
+        data->flag = EMPTY_FLAG;
+
+        return NULL;
+    }
+
+    return loadChunkFromMemory(data);
+}
+
+/**
+ * Prepares loading of a table from a stream while the stream is read (see continueStreamLoading())
+ * @param loading Loading to prepare
+ * @param delimiters Column delimiters
+ * @param columns Number of cells to load in each row (the other ones are only checked and kept as raw data)
+ */
+void startStreamLoading(StreamLoading *loading, DelimiterSet *delimiters, unsigned int columns) {
+    loading->delimiters = delimiters;
+    loading->columns = columns;
+    loading->chunks = NULL;
+    loading->count = 0;
+    loading->capacity = 0;
+    loading->joined = 0;
+    loading->split = 0;
+    loading->disabled = false;
+    loading->table = NULL;
+    loading->flag = EMPTY_FLAG;
+}
+
+/**
+ * Loads whole rows of a stream which have been read since the last call (by chunks in other threads)
+ * Rows of each chunk are loaded while the next part of the stream is read (and decompressed), so the read data mustn't
+ * be moved (cells of the rows are views into them). Only as many chunks as there are processors are loaded at once,
+ * the reading waits for the oldest one otherwise.
+ * @param loading Loading of the stream
+ * @param data All of the data read from the stream
+ * @param size Size of the read data
+ * @param end Has the whole stream been read? (the rest of the data is loaded in this thread then)
+ */
+void continueStreamLoading(StreamLoading *loading, const char *data, size_t size, bool end) {
+    // Binary snapshot of the table isn't loaded by rows (it's detected by its magic bytes at the start)
+    if (loading->split == 0 && !loading->disabled) {
+        if (size < sizeof(TABLE_SNAPSHOT_MAGIC) && !end) {
+            return;
+        }
+
+        loading->disabled = isTableSnapshot(data, size);
+    }
+
+    long processors = getProcessorsCount();
+    while (!loading->disabled && loading->split < size) {
+        // Chunks are split just behind line breaks (see splitIntoLoadingChunks()), the last one ends at the end
+        // of the stream
+        const char *start = data + loading->split;
+        const char *chunkEnd = data + size;
+        if (!end) {
+            const char *lineBreak;
+            if (size - loading->split < LOADING_CHUNK_MIN_SIZE
+                || (lineBreak = memchr(start + LOADING_CHUNK_MIN_SIZE - 1, '\n',
+                                       size - loading->split - (LOADING_CHUNK_MIN_SIZE - 1))) == NULL) {
+                break;
+            }
+
+            chunkEnd = lineBreak + 1;
+        }
+
+        // Array of the chunks is doubled when it's full
+        if (loading->count == loading->capacity) {
+            unsigned capacity = (loading->capacity > 0 ? 2 * loading->capacity : MAX_LOADING_THREADS);
+            StreamChunk **chunks;
+            if ((chunks = realloc(loading->chunks, capacity * sizeof(StreamChunk *))) == NULL) {
+                loading->disabled = true;
+
+                break;
+            }
+
+            loading->chunks = chunks;
+            loading->capacity = capacity;
+        }
+        StreamChunk *chunk;
+        if ((chunk = malloc(sizeof(StreamChunk))) == NULL) {
+            loading->disabled = true;
+
+            break;
+        }
+        initLoadingChunk(&(chunk->chunk), start, chunkEnd, loading->delimiters);
+        chunk->chunk.columns = loading->columns;
+        loading->chunks[loading->count++] = chunk;
+        loading->split = (size_t)(chunkEnd - data);
+
+        // The oldest chunks are waited for, if there are more of them than processors
+        while (processors > 0 && loading->count - loading->joined > (unsigned long)processors) {
+            StreamChunk *oldest = loading->chunks[loading->joined++];
+            if (oldest->threadStarted) {
+                pthread_join(oldest->thread, NULL);
+            }
+        }
+
+        // The last chunk is loaded right away (the same way as a chunk whose thread couldn't be created)
+        chunk->threadStarted = (!end && pthread_create(&(chunk->thread), NULL, measureAndLoadChunk, &(chunk->chunk)) == 0);
+        if (!chunk->threadStarted) {
+            measureAndLoadChunk(&(chunk->chunk));
+        }
+    }
+}
+
+/**
+ * Finishes loading of a stream (waits for all of its chunks) and puts the loaded rows together into the table
+ * The first unsuccessful chunk determines the result (the same error would be found by loading the whole data).
+ * @param loading Loading of the stream (its table is NULL then, if it hasn't been loaded, see its flag)
+ * @param success Has been the whole stream read successfully? (the loaded rows are only thrown away otherwise)
+ */
+void finishStreamLoading(StreamLoading *loading, bool success) {
+    for (unsigned i = loading->joined; i < loading->count; i++) {
+        if (loading->chunks[i]->threadStarted) {
+            pthread_join(loading->chunks[i]->thread, NULL);
+        }
+    }
+
+    // Stream without chunks hasn't been loaded (it's empty or it isn't a text table)
+    unsigned rowsCount = 0;
+    success = (success && !loading->disabled && loading->count > 0);
+    for (unsigned i = 0; success && i < loading->count; i++) {
+        if (loading->chunks[i]->chunk.flag != LAST_ROW) {
+            loading->flag = loading->chunks[i]->chunk.flag;
+            success = false;
+        }
+        rowsCount += loading->chunks[i]->chunk.size;
+    }
+
+    // Rows of the chunks are moved into the table, their arenas are merged into the table's one
+    Table *table = NULL;
+    if (success && ((table = createTable(rowsCount, loading->delimiters)) == NULL
+                    || (table->arena = createArena()) == NULL)) {
+        destructTable(table);
+        table = NULL;
+        success = false;
+    }
+    for (unsigned i = 0; i < loading->count; i++) {
+        LoadingChunk *chunk = &(loading->chunks[i]->chunk);
+        if (success) {
+            memcpy(table->rows + table->size, chunk->rows, chunk->size * sizeof(Row *));
+            table->size += chunk->size;
+            mergeArenas(table->arena, chunk->arena);
+        } else {
+            for (unsigned j = 0; j < chunk->size; j++) {
+                destructRow(chunk->rows[j]);
+            }
+            destructArena(chunk->arena);
+        }
+
+        free(chunk->rows);
+        free(loading->chunks[i]);
+    }
+    free(loading->chunks);
+    loading->chunks = NULL;
+    loading->count = 0;
+    loading->capacity = 0;
+    loading->joined = 0;
+
+    // Align rows to the same number of columns
+    if (success && alignRowSizes(table).error) {
+        destructTable(table);
+        table = NULL;
+        success = false;
+    }
+
+    if (success) {
+        loading->flag = LAST_ROW;
+    }
+    loading->table = table;
+}
+
+/**
+ * Splits input data into chunks for loading in parallel
+ * Chunks are split just behind line breaks. Line break always ends the row (if it's in the cell with borders, the cell
+ * is invalid and if it's behind '\\', it isn't escaped), so each chunk contains only whole rows.
+ * @param data Buffer with input data
+ * @param size Size of the buffer
+ * @param delimiters Column delimiters
+ * @param chunks Output array for chunks (at least MAX_LOADING_THREADS items)
+ * @return Number of created chunks
+ */
+unsigned int splitIntoLoadingChunks(const char *data, size_t size, DelimiterSet *delimiters, LoadingChunk *chunks) {
+    // Number of chunks is given by number of processors and size of the data
+    long processors = getProcessorsCount();
+    size_t wantedChunks = size / LOADING_CHUNK_MIN_SIZE;
+    if (processors > 0 && wantedChunks > (size_t)processors) {
+        wantedChunks = (size_t)processors;
+    }
+    if (wantedChunks > MAX_LOADING_THREADS) {
+        wantedChunks = MAX_LOADING_THREADS;
+    }
+    if (wantedChunks < 1) {
+        wantedChunks = 1;
+    }
+
+    // Split data to chunks of (nearly) the same size
+    const char *end = data + size;
+    const char *start = data;
+    unsigned chunksCount = 0;
+    for (size_t i = 1; i <= wantedChunks && start < end; i++) {
+        // The last chunk ends at the end of data, the other ones just behind the nearest line break
+        const char *chunkEnd = end;
+        if (i < wantedChunks) {
+            const char *splitPoint = data + (size / wantedChunks) * i;
+            if (splitPoint < start) {
+                // The previous chunk has already covered this one
+                continue;
+            }
+
+            const char *lineBreak;
+            if ((lineBreak = memchr(splitPoint, '\n', (size_t)(end - splitPoint))) != NULL) {
+                chunkEnd = lineBreak + 1;
+            }
+        }
+
+        initLoadingChunk(&(chunks[chunksCount]), start, chunkEnd, delimiters);
+        chunksCount++;
+
+        start = chunkEnd;
+    }
+
+    return chunksCount;
+}
+
+/**
+ * Initializes a chunk of input data (nothing is measured or loaded from it yet, all of its cells will be loaded)
+ * @param chunk Chunk to initialize
+ * @param start Start of the chunk's data
+ * @param end End of the chunk's data (the first byte behind)
+ * @param delimiters Column delimiters
+ */
+void initLoadingChunk(LoadingChunk *chunk, const char *start, const char *end, DelimiterSet *delimiters) {
+    chunk->start = start;
+    chunk->end = end;
+    chunk->delimiters = delimiters;
+    chunk->rows = NULL;
+    chunk->size = 0;
+    chunk->capacity = 0;
+    chunk->width = 0;
+    chunk->columns = UINT_MAX;
+    chunk->commands = NULL;
+    chunk->filled = 0;
+    chunk->message = NULL;
+    chunk->flag = EMPTY_FLAG;
+    chunk->arena = NULL;
+    chunk->heap = NULL;
+    chunk->heapOffset = 0;
+}
+
+/**
+ * Returns number of processors the work is split for (into chunks loaded or saved in parallel)
+ * FORCED_PROCESSORS can be defined at compile time instead of the real number, so the parallel paths are checked even
+ * on a single processor.
+ * @return Number of online processors (FORCED_PROCESSORS if it's defined, -1 if it isn't known)
+ */
+long getProcessorsCount(void) {
+#ifdef FORCED_PROCESSORS
+    return FORCED_PROCESSORS;
+#else
+    return sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+}
+
+/**
+ * Runs a function for each chunk of data (for the first chunk in this thread, for the other ones in their own
+ * threads)
+ * @param function Function to run (it gets pointer to the chunk)
+ * @param chunks Chunks to process (array of loading or saving chunks)
+ * @param chunkSize Size of one chunk
+ * @param chunksCount Number of chunks (at most MAX_LOADING_THREADS)
+ */
+void processChunksInParallel(void *(*function)(void *), void *chunks, size_t chunkSize, unsigned int chunksCount) {
+    pthread_t threads[MAX_LOADING_THREADS];
+    bool threadStarted[MAX_LOADING_THREADS];
+    for (unsigned i = 1; i < chunksCount; i++) {
+        threadStarted[i] = (pthread_create(&threads[i], NULL, function, (char *)chunks + i * chunkSize) == 0);
+    }
+    if (chunksCount > 0) {
+        function(chunks);
+    }
+    for (unsigned i = 1; i < chunksCount; i++) {
+        if (threadStarted[i]) {
+            pthread_join(threads[i], NULL);
+        } else {
+            // Thread couldn't be created, so the chunk is processed here
+            function((char *)chunks + i * chunkSize);
+        }
+    }
+}
+
+/**
+ * Opens a new file for replacing the existing one
+ * The new file is created in the same directory (so it can be renamed over the original one) with the same permissions
+ * (file which doesn't exist yet gets the default permissions given by the file mode creation mask)
+ * @param path Path to the file to replace
+ * @param replacementPath Output parameter for path of the new file (it must be freed by the caller)
+ * @return Opened file or NULL if error occurred
+ */
+FILE *openReplacementFile(const char *path, char **replacementPath) {
+    // Name of the new file is created from the original one (X chars are replaced by mkstemp())
+    char *tmpPath;
+    if ((tmpPath = malloc((strlen(path) + strlen(".XXXXXX") + 1) * sizeof(char))) == NULL) {
+        return NULL;
+    }
+    strcpy(tmpPath, path);
+    strcat(tmpPath, ".XXXXXX");
+
+    int fd;
+    if ((fd = mkstemp(tmpPath)) == -1) {
+        free(tmpPath);
+        return NULL;
+    }
+
+    // The new file gets the same permissions as the original one
+    struct stat fileInfo;
+    if (stat(path, &fileInfo) == 0) {
+        fchmod(fd, fileInfo.st_mode & 07777);
+    } else {
+        mode_t mask = umask(0);
+        umask(mask);
+        fchmod(fd, 0666 & ~mask);
+    }
+
+    FILE *file;
+    if ((file = fdopen(fd, "w")) == NULL) {
+        close(fd);
+        unlink(tmpPath);
+        free(tmpPath);
+        return NULL;
+    }
+
+    *replacementPath = tmpPath;
+    return file;
+}
+
+/**
+ * Opens the deferred output file (a new file for replacing the original one with a compressing process which writes
+ * into it)
+ * Broken pipe of the compressing process is reported as an error of writing, so the file isn't replaced by incomplete
+ * data (SIGPIPE is ignored while the compressing process runs, its previous handler is restored by the caller).
+ * @param deferred Deferred output file
+ * @param descriptor Output parameter for file descriptor of the stream of uncompressed data
+ * @return Error information
+ */
+ErrorInfo openDeferredOutput(DeferredOutput *deferred, int *descriptor) {
+    ErrorInfo err = {.error = false};
+
+    if ((deferred->file = openReplacementFile(deferred->path, &deferred->replacementPath)) == NULL) {
+        err.error = true;
+        err.message = "Zadany soubor se nepodarilo otevrit pro zapis.";
+
+        return err;
+    }
+
+    deferred->pipeHandler = signal(SIGPIPE, SIG_IGN);
+    if ((deferred->stream = openCompressionFilter(deferred->compression, fileno(deferred->file), true,
+                                                  &deferred->compressor)) == NULL) {
+        err.error = true;
+        err.message = "Zadany soubor se nepodarilo otevrit pro zapis.";
+
+        signal(SIGPIPE, deferred->pipeHandler);
+        fclose(deferred->file);
+        unlink(deferred->replacementPath);
+        free(deferred->replacementPath);
+        deferred->file = NULL;
+        deferred->replacementPath = NULL;
+        deferred->compressor = 0;
+        return err;
+    }
+
+    *descriptor = fileno(deferred->stream);
+    return err;
+}
+
+/**
+ * Constructs table with rows from indexed data
+ * Rows aren't loaded until they're needed (the data must stay available for the whole life of the table)
+ * @param index Index of the data (the table takes the ownership of it)
+ * @param cache Cache for the loaded rows (NULL if memory for them isn't limited), the table takes the ownership of it
+ * @return Table or NULL if error occurred
+ */
+Table *loadTableFromIndex(RowIndex *index, PageCache *cache) {
+    // Prepare new table with space for all of the rows
+    Table *table;
+    if ((table = createTable(index->size > 0 ? index->size : TABLE_START_CAPACITY, index->delimiters)) == NULL) {
+        return NULL;
+    }
+
+    // Add rows which will be loaded later
+    for (unsigned i = 0; i < index->size; i++) {
+        if ((table->rows[i] = createIndexedRow(index, i)) == NULL) {
+            // Index and cache stay owned by the caller
+            destructTable(table);
+            return NULL;
+        }
+
+        table->rows[i]->cache = cache;
+        table->size++;
+    }
+
+    table->index = index;
+    table->cache = cache;
+    if (cache != NULL) {
+        cache->index = index;
+    }
+
+    return table;
+}
+
+/**
+ * Builds row index of data in memory (the whole data are checked the same way as while loading)
+ * Rows of data which aren't in the canonical form can be loaded through the index, but they can't be copied from
+ * the data as they are (see saveTableToFile()).
+ * @param data Buffer with data to index
+ * @param size Size of the buffer
+ * @param delimiters Column delimiters
+ * @param flag Flag for returning special states (INVALID_INPUT_FORMAT for data with invalid format)
+ * @return Row index or NULL if error occurred
+ */
+RowIndex *buildRowIndex(const char *data, size_t size, DelimiterSet *delimiters, signed char *flag) {
+    RowIndex *index;
+    if ((index = createRowIndex(delimiters)) == NULL) {
+        return NULL;
+    }
+    index->source = data;
+    index->sourceSize = size;
+    index->canonical = true;
+
+    // Rows are only checked (all of their cells stay in the raw tail)
+    const char *position = data;
+    *flag = EMPTY_FLAG;
+    while (*flag != LAST_ROW) {
+        uint64_t offset = (uint64_t)(position - data);
+        Row *row;
+        if ((row = loadRowFromMemory(&position, data + size, delimiters, 1, 0, NULL, flag)) == NULL) {
+            destructRowIndex(index);
+            return NULL;
+        }
+
+        // Canonical data have the same number of cells in each row and the rows are saved the same way
+        if (!row->tailCanonical || (index->size > 0 && row->size != index->width)) {
+            index->canonical = false;
+        }
+        if (row->size > index->width) {
+            index->width = row->size;
+        }
+
+        ErrorInfo err = addRowToIndex(index, offset, row->tailFilled);
+        destructRow(row);
+        if (err.error) {
+            destructRowIndex(index);
+            return NULL;
+        }
+    }
+
+    return index;
+}
+
+/**
+ * Loads row index of the data from its file
+ * The index is used only if it belongs to the actual version of the data (it's checked by size and last modification
+ * time of the data file) and the data are in the canonical form (each row has the same number of cells etc.)
+ * @param path Path to the file with row index
+ * @param file File with the indexed data
+ * @param data Indexed data (the file mapped into memory)
+ * @param size Size of the data
+ * @param delimiters Column delimiters
+ * @return Row index or NULL if there isn't any usable row index
+ */
+RowIndex *loadRowIndex(const char *path, FILE *file, const char *data, size_t size, DelimiterSet *delimiters) {
+    // The data file must be the same as the one the index has been saved for
+    struct stat fileInfo;
+    if (fstat(fileno(file), &fileInfo) != 0 || size == 0 || data[size - 1] != '\n') {
+        return NULL;
+    }
+
+    FILE *indexFile;
+    if ((indexFile = fopen(path, "rb")) == NULL) {
+        return NULL;
+    }
+
+    // Header: magic, size and modification time of the data file, delimiters, stride, number of rows and cells
+    char magic[sizeof(ROW_INDEX_MAGIC)];
+    uint64_t header[3];
+    uint32_t numbers[4];
+    char storedDelimiters[256];
+    if (fread(magic, sizeof(magic), 1, indexFile) != 1 || memcmp(magic, ROW_INDEX_MAGIC, sizeof(magic)) != 0
+        || fread(header, sizeof(header), 1, indexFile) != 1 || fread(numbers, sizeof(numbers), 1, indexFile) != 1
+        || header[0] != (uint64_t)fileInfo.st_size || header[1] != (uint64_t)fileInfo.st_mtim.tv_sec
+        || header[2] != (uint64_t)fileInfo.st_mtim.tv_nsec || numbers[0] != delimiters->length
+        || numbers[1] == 0 || numbers[2] == 0 || numbers[3] == 0 || delimiters->length >= sizeof(storedDelimiters)
+        || fread(storedDelimiters, sizeof(char), delimiters->length, indexFile) != delimiters->length
+        || memcmp(storedDelimiters, delimiters->chars, delimiters->length) != 0) {
+        fclose(indexFile);
+        return NULL;
+    }
+
+    RowIndex *index;
+    if ((index = createRowIndex(delimiters)) == NULL) {
+        fclose(indexFile);
+        return NULL;
+    }
+
+    // Blocks of rows
+    index->stride = numbers[1];
+    unsigned blocks = (numbers[2] - 1) / index->stride + 1;
+    if ((index->offsets = malloc(blocks * sizeof(uint64_t))) == NULL
+        || (index->filledColumns = malloc(blocks * sizeof(uint32_t))) == NULL
+        || fread(index->offsets, sizeof(uint64_t), blocks, indexFile) != blocks
+        || fread(index->filledColumns, sizeof(uint32_t), blocks, indexFile) != blocks) {
+        destructRowIndex(index);
+        fclose(indexFile);
+        return NULL;
+    }
+    fclose(indexFile);
+
+    // Offsets must point into the data
+    for (unsigned i = 0; i < blocks; i++) {
+        if (index->offsets[i] >= size || (i > 0 && index->offsets[i] <= index->offsets[i - 1])) {
+            destructRowIndex(index);
+            return NULL;
+        }
+    }
+
+    index->source = data;
+    index->sourceSize = size;
+    index->size = numbers[2];
+    index->width = numbers[3];
+    index->capacity = blocks;
+    index->canonical = true;
+
+    return index;
+}
+
+/**
+ * Saves row index into its file
+ * The index is bound to the actual version of the indexed file (its size and last modification time), so it must be
+ * saved after the indexed file has been written. Index of data which aren't in the canonical form isn't saved
+ * and the old index file is removed.
+ * @param index Row index to save
+ * @param path Path to the file for row index
+ * @param indexedPath Path to the indexed file
+ * @return Has been the index saved?
+ */
+bool saveRowIndex(RowIndex *index, const char *path, const char *indexedPath) {
+    struct stat fileInfo;
+    if (!index->canonical || index->size == 0 || stat(indexedPath, &fileInfo) != 0 || !S_ISREG(fileInfo.st_mode)) {
+        unlink(path);
+        return false;
+    }
+
+    // The index file is replaced at once, so the old version can't be mixed with the new one
+    FILE *indexFile;
+    char *replacementPath;
+    if ((indexFile = openReplacementFile(path, &replacementPath)) == NULL) {
+        unlink(path);
+        return false;
+    }
+
+    uint64_t header[3] = {
+            (uint64_t)fileInfo.st_size, (uint64_t)fileInfo.st_mtim.tv_sec, (uint64_t)fileInfo.st_mtim.tv_nsec
+    };
+    uint32_t numbers[4] = {index->delimiters->length, index->stride, index->size, index->width};
+    unsigned blocks = (index->size - 1) / index->stride + 1;
+    bool success = (fwrite(ROW_INDEX_MAGIC, sizeof(ROW_INDEX_MAGIC), 1, indexFile) == 1
+                    && fwrite(header, sizeof(header), 1, indexFile) == 1
+                    && fwrite(numbers, sizeof(numbers), 1, indexFile) == 1
+                    && fwrite(index->delimiters->chars, sizeof(char), index->delimiters->length, indexFile)
+                       == index->delimiters->length
+                    && fwrite(index->offsets, sizeof(uint64_t), blocks, indexFile) == blocks
+                    && fwrite(index->filledColumns, sizeof(uint32_t), blocks, indexFile) == blocks);
+    if (fclose(indexFile) != 0 || !success || rename(replacementPath, path) != 0) {
+        unlink(replacementPath);
+        unlink(path);
+        success = false;
+    }
+
+    free(replacementPath);
+    return success;
+}
+
+/**
+ * Creates path to the file with row index of the file
+ * @param path Path to the indexed file
+ * @return Path to the file with row index (it must be freed by the caller) or NULL if error occurred
+ */
+char *getRowIndexPath(const char *path) {
+    char *indexPath;
+    if ((indexPath = malloc((strlen(path) + strlen(ROW_INDEX_SUFFIX) + 1) * sizeof(char))) == NULL) {
+        return NULL;
+    }
+    strcpy(indexPath, path);
+    strcat(indexPath, ROW_INDEX_SUFFIX);
+
+    return indexPath;
+}
+
+/**
+ * Checks if the data are binary snapshot of a table (by magic bytes at their start)
+ * @param data Data to check
+ * @param size Size of the data
+ * @return Are the data binary snapshot of a table?
+ */
+bool isTableSnapshot(const char *data, size_t size) {
+    return size >= sizeof(TABLE_SNAPSHOT_MAGIC) && memcmp(data, TABLE_SNAPSHOT_MAGIC, sizeof(TABLE_SNAPSHOT_MAGIC)) == 0;
+}
+
+/**
+ * Constructs table from its binary snapshot (format of the snapshot is described at saveTableToSnapshot())
+ * Cells are views into the heap of the snapshot, so nothing is parsed or copied (the data must stay available for
+ * the whole life of the table). Flags of the cells are taken from the snapshot, if it has been saved with the same
+ * delimiters (they're given by contents of the cells otherwise).
+ * @param data Snapshot data (the file mapped into memory)
+ * @param size Size of the data
+ * @param delimiters Column delimiters
+ * @param flag Flag for returning special states (INVALID_INPUT_FORMAT for damaged snapshot)
+ * @return Loaded table or NULL if error occurred
+ */
+Table *loadTableFromSnapshot(const char *data, size_t size, DelimiterSet *delimiters, signed char *flag) {
+    // Header: magic, size of the heap, number of rows, columns and delimiters
+    uint64_t heapSize;
+    uint32_t numbers[4];
+    size_t position = sizeof(TABLE_SNAPSHOT_MAGIC) + sizeof(heapSize) + sizeof(numbers);
+    if (size < position) {
+        *flag = INVALID_INPUT_FORMAT;
+        return NULL;
+    }
+    memcpy(&heapSize, data + sizeof(TABLE_SNAPSHOT_MAGIC), sizeof(heapSize));
+    memcpy(numbers, data + sizeof(TABLE_SNAPSHOT_MAGIC) + sizeof(heapSize), sizeof(numbers));
+
+    // Size of all parts must be the same as size of the data (delimiters are aligned to 8 bytes, so the offsets are
+    // aligned too)
+    unsigned rows = numbers[0];
+    unsigned columns = numbers[1];
+    uint64_t cells = (uint64_t)rows * columns;
+    uint64_t delimitersSize = ((uint64_t)numbers[2] + 7) / 8 * 8;
+    if (rows == 0 || columns == 0 || cells > size || heapSize > size || delimitersSize > size
+        || position + delimitersSize + (cells + columns) * sizeof(uint64_t) + cells + heapSize != size) {
+        *flag = INVALID_INPUT_FORMAT;
+        return NULL;
+    }
+    const char *storedDelimiters = data + position;
+    const uint64_t *offsets = (const uint64_t *)(data + position + delimitersSize);
+    const unsigned char *flags = (const unsigned char *)(offsets + cells + columns);
+    const char *heap = (const char *)(flags + cells);
+
+    // Offsets of each column must be ascending and they must point into the heap
+    for (unsigned j = 0; j < columns; j++) {
+        const uint64_t *columnOffsets = offsets + (size_t)j * (rows + 1);
+        for (unsigned i = 0; i < rows; i++) {
+            if (columnOffsets[i + 1] < columnOffsets[i] || columnOffsets[i + 1] > heapSize
+                || columnOffsets[i + 1] - columnOffsets[i] > UINT_MAX) {
+                *flag = INVALID_INPUT_FORMAT;
+                return NULL;
+            }
+        }
+    }
+    bool sameDelimiters = (numbers[2] == delimiters->length
+                           && memcmp(storedDelimiters, delimiters->chars, delimiters->length) == 0);
+
+    // Prepare new table with space for all of the rows (its cells are allocated from its arena)
+    Table *table;
+    if ((table = createTable(rows, delimiters)) == NULL) {
+        return NULL;
+    }
+    if ((table->arena = createArena()) == NULL) {
+        destructTable(table);
+        return NULL;
+    }
+
+    for (unsigned i = 0; i < rows; i++) {
+        Row *row;
+        if ((row = createRow(columns)) == NULL) {
+            destructTable(table);
+            return NULL;
+        }
+        table->rows[i] = row;
+        table->size++;
+
+        // Cells have no borders and escape chars in the heap, so their content is the same as their raw data
+        for (unsigned j = 0; j < columns; j++) {
+            Cell *cell;
+            if ((cell = createCell(table->arena)) == NULL) {
+                destructTable(table);
+                return NULL;
+            }
+
+            const uint64_t *columnOffsets = offsets + (size_t)j * (rows + 1);
+            cell->raw = heap + columnOffsets[i];
+            cell->rawSize = (unsigned)(columnOffsets[i + 1] - columnOffsets[i]);
+            cell->size = cell->rawSize;
+            if (sameDelimiters) {
+                cell->flags = flags[(size_t)j * rows + i] & (CELL_CONTENT_DELIMITER | CELL_CONTENT_SPECIAL);
+            } else {
+                for (unsigned k = 0; k < cell->rawSize; k++) {
+                    cell->flags |= getCharFlags(delimiters, cell->raw[k]);
+                }
+            }
+
+            row->cells[j] = cell;
+            row->size++;
+            row->loaded++;
+        }
+    }
+
+    return table;
+}
+
+/**
+ * Maps the whole file into memory (read only)
+ * @param file File to map
+ * @param size Output parameter for size of the mapped data
+ * @return Pointer to the mapped data or NULL if the file can't be mapped (it isn't regular file, it's empty etc.)
+ */
+char *mapFileToMemory(FILE *file, size_t *size) {
+    // Only non-empty regular files can be mapped (pipes etc. must be read as a stream)
+    struct stat fileInfo;
+    if (fstat(fileno(file), &fileInfo) != 0 || !S_ISREG(fileInfo.st_mode) || fileInfo.st_size <= 0) {
+        return NULL;
+    }
+
+    void *data;
+    if ((data = mmap(NULL, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, fileno(file), 0)) == MAP_FAILED) {
+        return NULL;
+    }
+
+    // Data will be read sequentially from the start to the end
+    posix_madvise(data, (size_t)fileInfo.st_size, POSIX_MADV_SEQUENTIAL);
+
+    *size = (size_t)fileInfo.st_size;
+    return data;
+}
+
+/**
+ * Reads the whole stream into memory mapped the same way as files (it can be unmapped by munmap())
+ * Address space for the whole stream is reserved at first and only its part with the read data uses memory, the data
+ * are never moved, so rows of the table can be loaded from them while the rest of the stream is read.
+ * @param file Stream to read (it's read to its end)
+ * @param data Output parameter for the read data (NULL if there are no data)
+ * @param size Output parameter for size of the read data
+ * @param mapped Output parameter for size of the mapped memory (the whole size must be passed to munmap())
+ * @param loading Loading of the table from the read data (NULL if the table isn't loaded while the stream is read),
+ *                it's finished when the stream has been read (see finishStreamLoading())
+ * @return Error information
+ */
+ErrorInfo readStreamToMemory(FILE *file, char **data, size_t *size, size_t *mapped, StreamLoading *loading) {
+    ErrorInfo err = {.error = false};
+
+    // Memory is mapped from /dev/zero (anonymous mapping isn't available in POSIX), the reserved space is inaccessible
+    // until it's needed for the data (smaller space is reserved, if there isn't so much of it)
+    int zero;
+    char *buffer = MAP_FAILED;
+    size_t reserved = STREAM_RESERVED_SIZE;
+    if ((zero = open("/dev/zero", O_RDWR)) != -1) {
+        while ((buffer = mmap(NULL, reserved, PROT_NONE, MAP_PRIVATE, zero, 0)) == MAP_FAILED
+               && reserved > STREAM_BUFFER_START_SIZE) {
+            reserved /= 2;
+        }
+        close(zero);
+    }
+    if (buffer == MAP_FAILED) {
+        if (loading != NULL) {
+            finishStreamLoading(loading, false);
+        }
+        err.error = true;
+        err.message = "Nepodarilo se alokovat pamet pro vstupni data.";
+
+        return err;
+    }
+
+    // Accessible part of the reserved space is doubled when it's full (by whole pages)
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t capacity = 0;
+    *size = 0;
+    *mapped = 0;
+    while (!err.error) {
+        if (*size == capacity) {
+            size_t newCapacity = (capacity == 0 ? STREAM_BUFFER_START_SIZE : 2 * capacity);
+            newCapacity = (newCapacity + pageSize - 1) / pageSize * pageSize;
+            if (newCapacity > reserved) {
+                newCapacity = reserved;
+            }
+            if (capacity == reserved || mprotect(buffer + capacity, newCapacity - capacity, PROT_READ | PROT_WRITE) != 0) {
+                err.error = true;
+                err.message = "Nepodarilo se alokovat pamet pro vstupni data.";
+
+                break;
+            }
+            capacity = newCapacity;
+        }
+
+        // Data are read by blocks, whole rows of each block are loaded while the next one is read
+        size_t block = capacity - *size;
+        if (block > STREAM_BUFFER_START_SIZE) {
+            block = STREAM_BUFFER_START_SIZE;
+        }
+        size_t loaded = fread(buffer + *size, sizeof(char), block, file);
+        *size += loaded;
+        if (loaded == 0 && ferror(file)) {
+            err.error = true;
+            err.message = "Vstupni soubor se nepodarilo precist.";
+        } else if (loaded == 0) {
+            break;
+        } else if (loading != NULL) {
+            continueStreamLoading(loading, buffer, *size, false);
+        }
+    }
+
+    // The rest of the data is loaded and the loaded rows are put together (they're thrown away after an error)
+    if (loading != NULL) {
+        if (!err.error) {
+            continueStreamLoading(loading, buffer, *size, true);
+        }
+        finishStreamLoading(loading, !err.error);
+    }
+
+    if (err.error || *size == 0) {
+        munmap(buffer, reserved);
+        *data = NULL;
+
+        return err;
+    }
+
+    // Reserved pages behind the data are returned right away, the rest of the mapping stays mapped with them
+    size_t used = (*size + pageSize - 1) / pageSize * pageSize;
+    if (used < reserved) {
+        munmap(buffer + used, reserved - used);
+    }
+    *data = buffer;
+    *mapped = used;
+
+    return err;
+}
+
+/**
+ * Loads commands from string into command sequence
+ * @param string String with commands
+ * @param flag Flag for returning additional information
+ * @return Command sequence with loaded commands
+ */
+CommandSequence *loadCommandsFromString(const char *string, signed char *flag) {
+    CommandSequence *cmdSeq;
+    if ((cmdSeq = createCmdSeq()) == NULL) {
+        return NULL;
+    }
+
+    // Prepare first command
+    Command *cmd;
+    if ((cmd = createCmd()) == NULL) {
+        return NULL;
+    }
+
+    // Parse string to commands
+    unsigned i, cmdI, paramI;
+    for (i = cmdI = paramI = 0; i < strlen(string); i++) {
+        if (string[i] == ';') {
+            // Close the command
+            addNewCmdToSeq(cmdSeq, cmd);
+
+            // Prepare the next command
+            cmdI = 0;
+            paramI = 0;
+            if ((cmd = createCmd()) == NULL) {
+                return NULL;
+            }
+        } else if(string[i] == ' ' && string[i - 1] != '\\') {
+            // Move to the next parameter
+            paramI++;
+            // Reset parameter string iteration var
+            cmdI = 0;
+        } else {
+            // Selection commands: [R, C], [R1,C1,R2,C2], [_] and [_,_]
+            if (cmdI == 0 && string[i] == '[' && (isdigit(string[i + 1]) || string[i + 1] == '_')) {
+                // Skip the '[' char
+                i++;
+
+                // Set the name for selection commands
+                // Classic commands has already had name, so only process selection contains in its parameter
+                if (paramI == 0) {
+                    // Set a type and a name (this type of commands doesn't have a name in input string)
+                    cmd->type = SELECTION_COMMAND;
+                    memcpy(cmd->name, "select", 7);
+                    paramI = 1;
+                }
+
+                // Load parameters
+                while (string[i] != ']' && string[i] != ';') {
+                    if (string[i] == ',') {
+                        // Move to the next parameter
+                        paramI++;
+                        // Reset parameter string iteration var
+                        cmdI = 0;
+                    } else {
+                        // Resize string parameters to cmd + 2 for the saving of the next char
+                        // cmd + 2: indexing from 0 and space for '\0'
+                        // [0] => name, [1] => firstParameter --> -1 (array with parameters start at index 0)
+                        char **param = &(cmd->strParams[paramI - 1]);
+                        char *tmp;
+                        if ((tmp = realloc(*param, sizeof(char) * (cmdI + 2))) == NULL) {
+                            return NULL;
+                        } else {
+                            *param = tmp;
+                        }
+
+                        // Save the char
+                        (*param)[cmdI] = string[i];
+                        (*param)[cmdI + 1] = '\0';
+                    }
+
+                    i++;
+                }
+
+                if (string[i] == ';') {
+                    *flag = INVALID_INPUT_FORMAT;
+
+                    return NULL;
+                }
+
+                continue;
+            }
+
+            // Skip ']' char at the end of selection commands
+            if (string[i] == ']' && (string[i + 1] == ' ' || string[i + 1] == ';' || string[i + 1] == '\0')) {
+                continue;
+            }
+
+            // Data processing commands and named selection commands ([min], [max], [find STR], [set])
+            // Loading command name
+            if (paramI == 0) {
+                // Skip '[' char at the start of selection commands and set command type
+                if (cmdI == 0 && string[i] == '[') {
+                    cmd->type = SELECTION_COMMAND;
+                    continue;
+                }
+
+                cmd->name[cmdI] = string[i];
+            } else {
+                // Skip escape char
+                if (string[i] == '\\' && string[i - 1] != '\\') {
+                    continue;
+                }
+
+                // Resize string parameters to cmd + 2 for the saving of the next char
+                // cmd + 2: indexing from 0 and space for '\0'
+                // [0] => name, [1] => firstParameter --> -1 (array with parameters start at index 0)
+                char **param = &(cmd->strParams[paramI - 1]);
+                char *tmp;
+                if ((tmp = realloc(*param, sizeof(char) * (cmdI + 2))) == NULL) {
+                    return NULL;
+                } else {
+                    *param = tmp;
+                }
+
+                // Save the char
+                (*param)[cmdI] = string[i];
+                (*param)[cmdI + 1] = '\0';
+            }
+
+            // Increment command name/parameter string iteration var
+            cmdI++;
+        }
+    }
+
+    // Close the last command
+    addNewCmdToSeq(cmdSeq, cmd);
+
+    // Convert string to int types of parameters
+    convertTypesInCommandParams(cmdSeq);
+
+    return cmdSeq;
+}
+
+/**
+ * Measures the table in a memory buffer as it would look like after applying commands on it
+ * The table isn't kept in memory, rows are loaded and processed one by one (in parallel for big buffers). Rows
+ * of the processed table are then saved by streamTableToFile().
+ * <strong>Warning! The commands must be row-local (see isRowLocal())</strong>
+ * @param data Buffer with data for the table
+ * @param size Size of the buffer (it mustn't be empty)
+ * @param delimiters Column delimiters
+ * @param cmdSeq Row-local commands to apply
+ * @param width Output parameter for number of cells in the widest row of the loaded table
+ * @param filled Output parameter for the most filled columns of the processed table (its width after trimming)
+ * @return Error information
+ */
+ErrorInfo measureProcessedTable(const char *data, size_t size, DelimiterSet *delimiters, CommandSequence *cmdSeq,
+                                unsigned int *width, unsigned int *filled) {
+    ErrorInfo err = {.error = false};
+
+    // Measure chunks of data (numbers of cells in the widest rows), each row is aligned to the widest one before
+    // the commands are applied
+    LoadingChunk chunks[MAX_LOADING_THREADS];
+    unsigned chunksCount = splitIntoLoadingChunks(data, size, delimiters, chunks);
+    processChunksInParallel(measureChunk, chunks, sizeof(LoadingChunk), chunksCount);
+
+    *width = 0;
+    for (unsigned i = 0; i < chunksCount; i++) {
+        if (chunks[i].width > *width) {
+            *width = chunks[i].width;
+        }
+    }
+
+    // Process rows of the chunks (only the used columns are loaded)
+    for (unsigned i = 0; i < chunksCount; i++) {
+        chunks[i].width = *width;
+        chunks[i].columns = getUsedColumns(cmdSeq);
+        chunks[i].commands = cmdSeq;
+    }
+    processChunksInParallel(measureProcessedChunk, chunks, sizeof(LoadingChunk), chunksCount);
+
+    // Invalid input is reported first (the whole table would be loaded before applying commands), then the first
+    // unsuccessful chunk determines the result
+    *filled = 0;
+    for (unsigned i = 0; i < chunksCount; i++) {
+        if (chunks[i].flag == INVALID_INPUT_FORMAT) {
+            err.error = true;
+            err.message = "Vstupni soubor obsahuje bunku v chybnem formatu.";
+
+            return err;
+        }
+    }
+    for (unsigned i = 0; i < chunksCount; i++) {
+        if (chunks[i].flag != LAST_ROW) {
+            err.error = true;
+            err.message = "Nepodarilo se nacist tabulku z duvodu chyby pri alokaci pameti.";
+
+            return err;
+        } else if (chunks[i].message != NULL) {
+            err.error = true;
+            err.message = chunks[i].message;
+
+            return err;
+        }
+
+        if (chunks[i].filled > *filled) {
+            *filled = chunks[i].filled;
+        }
+    }
+
+    return err;
+}
+
+/**
+ * Loads the table from a memory buffer row by row, applies commands on each row and saves it to the file
+ * Only one row is kept in memory at a time. The result is the same as loading of the whole table, processing it and
+ * saving it using saveTableToFile().
+ * <strong>Warning! The table must be already measured using measureProcessedTable()</strong>
+ * @param data Buffer with data for the table
+ * @param size Size of the buffer
+ * @param delimiters Column delimiters
+ * @param cmdSeq Row-local commands to apply
+ * @param width Number of cells in the widest row of the loaded table
+ * @param filled The most filled columns of the processed table (saved rows are trimmed to them)
+ * @param output The buffer of the file to save the table into (data stay in it, see finishOutput())
+ * @param index Index to build for the saved data (NULL if the index isn't wanted)
+ * @return Error information
+ */
+ErrorInfo streamTableToFile(const char *data, size_t size, DelimiterSet *delimiters, CommandSequence *cmdSeq,
+                            unsigned int width, unsigned int filled, OutputBuffer *output, RowIndex *index) {
+    ErrorInfo err = {.error = false};
+
+    // Each row is processed as a single-row table
+    Table *table;
+    if ((table = createTable(TABLE_START_CAPACITY, delimiters)) == NULL) {
+        err.error = true;
+        err.message = "Nepodarilo se alokovat pamet pro tabulku.";
+
+        return err;
+    }
+
+    // Saved rows have the same number of cells (see saveTableToFile())
+    if (index != NULL) {
+        index->width = filled;
+        index->canonical = (index->width > 0);
+    }
+
+    const char *position = data;
+    unsigned columns = getUsedColumns(cmdSeq);
+    unsigned rowCapacity = (width < columns ? width : columns);
+    signed char flag = EMPTY_FLAG;
+    while (flag != LAST_ROW) {
+        // Rows have been already checked while measuring, so loading can fail only by cause of memory allocation
+        Row *row;
+        if ((row = loadRowFromMemory(&position, data + size, delimiters, (rowCapacity > 0 ? rowCapacity : 1),
+                                     columns, NULL, &flag)) == NULL) {
+            err.error = true;
+            err.message = "Nepodarilo se nacist tabulku z duvodu chyby pri alokaci pameti.";
+
+            break;
+        }
+
+        // Apply commands and trim the row the same way as the whole table
+        table->rows[0] = row;
+        table->size = 1;
+        if ((err = resizeTable(table, 1, width)).error || (err = processCommands(cmdSeq, table)).error) {
+            break;
+        }
+        for (unsigned j = row->size; j > filled; j--) {
+            if ((err = deleteColumnFromTable(table, j)).error) {
+                break;
+            }
+        }
+        if (err.error || (err = saveRowToFile(row, output, delimiters, index)).error) {
+            break;
+        }
+
+        destructRow(row);
+        table->size = 0;
+    }
+
+    destructTable(table);
+
+    return err;
+}
+
+/**
+ * Saves table data to the file
+ * @param table Table to save
+ * @param output The buffer of the file to save the table into (data stay in it, see finishOutput())
+ * @param delimiter Column delimiter
+ * @param index Index to build for the saved data (NULL if the index isn't wanted)
+ * @return Error information
+ */
+ErrorInfo saveTableToFile(Table *table, OutputBuffer *output, DelimiterSet *delimiters, RowIndex *index) {
+    ErrorInfo err = {.error = false};
+
+    // Trim rows of the table
+    if ((err = trimRows(table)).error) {
+        return err;
+    }
+
+    // Saved rows have the same number of cells and they can't be without cells (empty line is a row with one cell)
+    if (index != NULL) {
+        index->width = table->rows[0]->size;
+        index->canonical = (index->width > 0);
+    }
+
+    RowIndex *source = table->index;
+    bool parallel = (table->cache == NULL && getProcessorsCount() > 1);
+    unsigned serialEnd = 0;
+    for (unsigned i = 0; i < table->size && !err.error; i++) {
+        Row *row = getTableRow(table, i);
+
+        // Rows which haven't been found in the indexed data or haven't been modified are copied from it at once
+        // (they're in the canonical form and they have the same number of cells as the other rows), other rows must
+        // be loaded (evicted rows too)
+        if (isRowSavedAsIndexed(table, i)) {
+            unsigned last = i;
+            while (last + 1 < table->size && isRowSavedAsIndexed(table, last + 1)
+                   && getTableRow(table, last + 1)->sourceRow == getTableRow(table, last)->sourceRow + 1) {
+                last++;
+            }
+
+            const char *start = findIndexedRow(source, row->sourceRow);
+            const char *end = findIndexedRow(source, getTableRow(table, last)->sourceRow + 1);
+            if (index != NULL) {
+                off_t offset = output->passed + (off_t)output->size;
+                for (unsigned k = i; k <= last && !err.error; k++) {
+                    // Offset is needed only for the first row of the block
+                    uint64_t rowOffset = 0;
+                    if (index->size % index->stride == 0) {
+                        rowOffset = (uint64_t)offset
+                                + (uint64_t)(findIndexedRow(source, getTableRow(table, k)->sourceRow) - start);
+                    }
+
+                    unsigned filled = source->filledColumns[getTableRow(table, k)->sourceRow / source->stride];
+                    err = addRowToIndex(index, rowOffset, filled);
+                }
+            }
+
+            if (!err.error) {
+                err = writeToOutput(output, start, (size_t)(end - start));
+            }
+            i = last;
+
+            continue;
+        }
+
+        // Long runs of rows which are in memory are saved in parallel (rows of indexed data and paged rows are loaded
+        // while saving, it can't be done in parallel)
+        if (i >= serialEnd) {
+            unsigned end = i;
+            while (parallel && end < table->size && getTableRow(table, end)->source == NULL
+                   && !isRowSavedAsIndexed(table, end)) {
+                end++;
+            }
+
+            if (end - i >= 2 * SAVING_CHUNK_ROWS) {
+                err = saveRowsInParallel(table, i, end, output, delimiters, index);
+                i = end - 1;
+
+                continue;
+            }
+            serialEnd = (end > i ? end : i + 1);
+        }
+
+        if (!(err = materializeRow(row, 0)).error && !(err = saveRowToFile(row, output, delimiters, index)).error) {
+            err = evictRows(table);
+        }
+    }
+
+    return err;
+}
+
+/**
+ * Saves rows of the table in parallel
+ * Chunks of rows are saved into memory buffers in parallel and the buffers are passed to the output in the original
+ * order, then the next chunks are saved.
+ * <strong>Warning! The rows must be in memory (not in indexed data or evicted)</strong>
+ * @param table Table with the rows
+ * @param start Number of the first saved row (indexed from 0)
+ * @param end Number of the first row behind the saved ones
+ * @param output The buffer of the file to save the rows into
+ * @param delimiters Column delimiters
+ * @param index Index to add the rows into (NULL if the index isn't wanted)
+ * @return Error information
+ */
+ErrorInfo saveRowsInParallel(Table *table, unsigned int start, unsigned int end, OutputBuffer *output,
+                             DelimiterSet *delimiters, RowIndex *index) {
+    ErrorInfo err = {.error = false};
+
+    // Number of chunks saved at once is given by number of processors
+    long processors = getProcessorsCount();
+    unsigned threads = (processors > 1 ? (unsigned)processors : 1);
+    if (threads > MAX_LOADING_THREADS) {
+        threads = MAX_LOADING_THREADS;
+    }
+
+    SavingChunk chunks[MAX_LOADING_THREADS];
+    unsigned first = start;
+    while (first < end && !err.error) {
+        // Prepare chunks (each of them has its own memory buffer and index with offsets of all rows)
+        unsigned chunksCount = 0;
+        while (chunksCount < threads && first < end && !err.error) {
+            SavingChunk *chunk = &chunks[chunksCount++];
+            chunk->rows = &(table->rows[first]);
+            chunk->size = (end - first < SAVING_CHUNK_ROWS ? end - first : SAVING_CHUNK_ROWS);
+            chunk->delimiters = delimiters;
+            chunk->index = NULL;
+            chunk->err.error = false;
+            first += chunk->size;
+
+            if ((chunk->output = createOutputBuffer(NULL, NULL, 0, -1, -1, false, NULL)) == NULL
+                || (index != NULL && (chunk->index = createRowIndex(delimiters)) == NULL)) {
+                err.error = true;
+                err.message = "Nepodarilo se alokovat pamet pro zapis tabulky.";
+            } else if (chunk->index != NULL) {
+                chunk->index->stride = 1;
+                chunk->index->canonical = true;
+            }
+        }
+
+        if (!err.error) {
+            processChunksInParallel(saveChunkToMemory, chunks, sizeof(SavingChunk), chunksCount);
+        }
+
+        // Pass data of the chunks to the output in the original order
+        for (unsigned i = 0; i < chunksCount; i++) {
+            if (!err.error) {
+                err = chunks[i].err;
+            }
+
+            if (!err.error && index != NULL) {
+                off_t offset = output->passed + (off_t)output->size;
+                RowIndex *chunkIndex = chunks[i].index;
+                for (unsigned k = 0; k < chunkIndex->size && !err.error; k++) {
+                    // Offset is needed only for the first row of the block
+                    uint64_t rowOffset = 0;
+                    if (index->size % index->stride == 0) {
+                        rowOffset = (uint64_t)offset + chunkIndex->offsets[k];
+                    }
+
+                    err = addRowToIndex(index, rowOffset, chunkIndex->filledColumns[k]);
+                }
+                if (!chunkIndex->canonical) {
+                    index->canonical = false;
+                }
+            }
+
+            if (!err.error) {
+                err = passOutputBlocks(output, chunks[i].output);
+            }
+            destructOutputBuffer(chunks[i].output);
+            destructRowIndex(chunks[i].index);
+        }
+    }
+
+    return err;
+}
+
+/**
+ * Saves rows of the chunk into its memory buffer (function of the saving threads)
+ * @param chunkPointer Chunk to save
+ * @return NULL
+ */
+void *saveChunkToMemory(void *chunkPointer) {
+    SavingChunk *chunk = chunkPointer;
+
+    for (unsigned i = 0; i < chunk->size && !chunk->err.error; i++) {
+        if (!(chunk->err = materializeRow(chunk->rows[i], 0)).error) {
+            chunk->err = saveRowToFile(chunk->rows[i], chunk->output, chunk->delimiters, chunk->index);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Saves the row to the output buffer (the row must be already loaded)
+ * @param row Row to save
+ * @param output The buffer of the file to save the row into
+ * @param delimiters Column delimiters
+ * @param index Index to add the row into (NULL if the index isn't wanted)
+ * @return Error information
+ */
+ErrorInfo saveRowToFile(Row *row, OutputBuffer *output, DelimiterSet *delimiters, RowIndex *index) {
+    ErrorInfo err = {.error = false};
+
+    // Main delimiter
+    char mainDelimiter = delimiters->chars[0];
+
+    if (index != NULL) {
+        uint64_t rowOffset = (index->size % index->stride == 0 ? (uint64_t)(output->passed + output->size) : 0);
+        if ((err = addRowToIndex(index, rowOffset, getFilledColumns(row))).error) {
+            return err;
+        }
+    }
+
+    bool *canonical = (index != NULL ? &(index->canonical) : NULL);
+    for (unsigned j = 0; j < row->loaded; j++) {
+        if ((err = saveCellToFile(row->cells[j], output, delimiters, canonical)).error) {
+            return err;
+        }
+
+        // Add delimiter if not last
+        if (j + 1 < row->size && (err = writeToOutput(output, &mainDelimiter, 1)).error) {
+            return err;
+        }
+    }
+
+    // Cells of the compact row are saved as views into its heap (the row isn't expanded)
+    for (unsigned j = 0; row->spans != NULL && j < row->size; j++) {
+        Cell cell = {.content.allocated.data = NULL, .raw = NULL, .size = 0, .rawSize = 0, .flags = 0};
+        viewCompactCell(row, j, &cell);
+        if ((err = saveCellToFile(&cell, output, delimiters, canonical)).error) {
+            return err;
+        }
+
+        // Add delimiter if not last
+        if (j + 1 < row->size && (err = writeToOutput(output, &mainDelimiter, 1)).error) {
+            return err;
+        }
+    }
+
+    // Raw tail in the canonical form is copied as it is (without line break), otherwise its cells are saved
+    // one by one
+    if (row->tail != NULL && row->tailCanonical) {
+        if ((err = writeToOutput(output, row->tail, row->tailSize - 1)).error) {
+            return err;
+        }
+    } else if (row->tail != NULL) {
+        const char *position = row->tail;
+        signed char flag = EMPTY_FLAG;
+        for (unsigned j = row->loaded; j < row->size; j++) {
+            Cell cell = {.content.allocated.data = NULL, .raw = NULL, .size = 0, .rawSize = 0, .flags = 0};
+            scanCellFromMemory(&position, row->tail + row->tailSize, row->tailDelimiters, &cell, &flag);
+            if ((err = saveCellToFile(&cell, output, delimiters, canonical)).error) {
+                return err;
+            }
+
+            // Add delimiter if not last
+            if (j + 1 < row->size && (err = writeToOutput(output, &mainDelimiter, 1)).error) {
+                return err;
+            }
+        }
+    }
+
+    // Add line break
+    return writeToOutput(output, "\n", 1);
+}
+
+/**
+ * Saves the cell to the output buffer (with borders and escape chars, if they're needed)
+ * @param cell Cell to save
+ * @param output The buffer of the file to save the cell into
+ * @param delimiters Column delimiters
+ * @param canonical Output parameter which is set to false if the saved cell wouldn't be loaded the same way
+ *                  (NULL if it isn't needed)
+ * @return Error information
+ */
+ErrorInfo saveCellToFile(Cell *cell, OutputBuffer *output, DelimiterSet *delimiters, bool *canonical) {
+    ErrorInfo err = {.error = false};
+
+    // Views (cells without own data) are written directly from their raw data (borders and escape chars
+    // in the raw data are skipped)
+    const char *data = getCellData(cell);
+    const char *content = (data != NULL ? data : cell->raw);
+    unsigned contentSize = (data != NULL ? cell->size : cell->rawSize);
+    bool encoded = (data == NULL && (cell->flags & CELL_RAW_ENCODED));
+
+    // Borders are required for cell contains delimiter, special chars must be escaped (flags of the content are kept
+    // by the loader and by changes of the cell)
+    bool borders = (cell->flags & CELL_CONTENT_DELIMITER);
+    bool escaped = (cell->flags & CELL_CONTENT_SPECIAL);
+
+    // Content without chars to escape (or skip) is copied at once
+    if (!encoded && !escaped && !borders) {
+        return writeToOutput(output, content, contentSize);
+    }
+
+    // There is space for the worst case (each char escaped and both borders)
+    char *out;
+    if ((out = reserveOutput(output, 2 * (size_t)contentSize + 2, &err)) == NULL) {
+        return err;
+    }
+    char *outStart = out;
+
+    // Print left border
+    if (borders) {
+        *out++ = '"';
+    }
+
+    int prevC = '\0';
+    for (unsigned k = 0; k < contentSize; k++) {
+        int c = (unsigned char)content[k];
+        bool skip = (encoded && isEncodingChar(c, prevC));
+        prevC = c;
+
+        // Borders and escape chars of the raw data aren't a part of the content
+        if (skip) {
+            continue;
+        }
+
+        // Line breaks and backslashes aren't loaded back the same way (the row would be split or the escape
+        // char would be taken as escaped one)
+        if (canonical != NULL && (c == '\n' || c == '\\')) {
+            *canonical = false;
+        }
+
+        // Add backslash before escaped characters
+        if (isSpecialChar(delimiters, c)) {
+            *out++ = '\\';
+        }
+
+        // Print char from cell data
+        *out++ = (char)c;
+    }
+
+    // Print right border
+    if (borders) {
+        *out++ = '"';
+    }
+
+    output->size += (size_t)(out - outStart);
+
+    return err;
+}
+
+/**
+ * Saves the table as its binary snapshot, which can be loaded back without parsing (see loadTableFromSnapshot())
+ * The snapshot consists of these parts:
+ * - header: magic, size of the heap (uint64), number of rows, columns and delimiters (4x uint32, the last one is 0)
+ * - delimiters the table has been saved with (aligned to 8 bytes by zero bytes)
+ * - offsets of cells in the heap (uint64), rows + 1 offsets for each column (the last one is the end of the column)
+ * - flags of cells (CELL_CONTENT_* flags, one byte for each cell), column by column
+ * - heap with contents of cells (without borders and escape chars), column by column
+ * @param table Table to save
+ * @param output The buffer of the file to save the snapshot into
+ * @return Error information
+ */
+ErrorInfo saveTableToSnapshot(Table *table, OutputBuffer *output) {
+    ErrorInfo err = {.error = false};
+
+    // The table is trimmed the same way as the saved text, table without columns has one empty column (the text has
+    // only empty lines, they're loaded as rows with one empty cell)
+    if ((err = trimRows(table)).error) {
+        return err;
+    }
+    unsigned rows = table->size;
+    unsigned width = getTableRow(table, 0)->size;
+    unsigned columns = (width > 0 ? width : 1);
+    size_t cells = (size_t)rows * columns;
+
+    uint64_t *offsets;
+    unsigned char *flags;
+    if ((offsets = malloc((cells + columns) * sizeof(uint64_t))) == NULL
+        || (flags = malloc(cells * sizeof(unsigned char))) == NULL) {
+        free(offsets);
+
+        err.error = true;
+        err.message = "Nepodarilo se alokovat pamet pro zapis tabulky.";
+
+        return err;
+    }
+
+    // Sizes and flags of cells are measured row by row (rows are loaded only for it, the cells stay views into
+    // the input data), then the sizes are summed up to the offsets column by column
+    for (unsigned i = 0; i < rows && !err.error; i++) {
+        Row *row = getTableRow(table, i);
+        if ((err = materializeRow(row, row->size)).error) {
+            break;
+        }
+
+        for (unsigned j = 0; j < columns; j++) {
+            Cell *cell = (j < width ? row->cells[j] : NULL);
+            offsets[(size_t)j * (rows + 1) + i + 1] = (cell != NULL ? cell->size : 0);
+            flags[(size_t)j * rows + i] = (cell != NULL ? cell->flags & (CELL_CONTENT_DELIMITER | CELL_CONTENT_SPECIAL)
+                                                        : 0);
+        }
+
+        err = evictRows(table);
+    }
+    uint64_t heapSize = 0;
+    for (unsigned j = 0; j < columns; j++) {
+        uint64_t *columnOffsets = offsets + (size_t)j * (rows + 1);
+        columnOffsets[0] = heapSize;
+        for (unsigned i = 0; i < rows; i++) {
+            heapSize += columnOffsets[i + 1];
+            columnOffsets[i + 1] = heapSize;
+        }
+    }
+
+    // Header, delimiters, offsets and flags
+    DelimiterSet *delimiters = table->delimiters;
+    uint32_t numbers[4] = {rows, columns, delimiters->length, 0};
+    char padding[8] = {0};
+    if (!err.error && !(err = writeToOutput(output, TABLE_SNAPSHOT_MAGIC, sizeof(TABLE_SNAPSHOT_MAGIC))).error
+        && !(err = writeToOutput(output, (char *)&heapSize, sizeof(heapSize))).error
+        && !(err = writeToOutput(output, (char *)numbers, sizeof(numbers))).error
+        && !(err = writeToOutput(output, delimiters->chars, delimiters->length)).error
+        && !(err = writeToOutput(output, padding, (8 - delimiters->length % 8) % 8)).error
+        && !(err = writeToOutput(output, (char *)offsets, (cells + columns) * sizeof(uint64_t))).error) {
+        err = writeToOutput(output, (char *)flags, cells * sizeof(unsigned char));
+    }
+    free(offsets);
+    free(flags);
+
+    // Heap (contents of encoded views are decoded directly into the output)
+    for (unsigned j = 0; j < width && !err.error; j++) {
+        for (unsigned i = 0; i < rows && !err.error; i++) {
+            if ((err = materializeRow(getTableRow(table, i), j + 1)).error) {
+                break;
+            }
+
+            Cell *cell = getTableRow(table, i)->cells[j];
+            if (getCellData(cell) != NULL) {
+                err = writeToOutput(output, getCellData(cell), cell->size);
+            } else if (!(cell->flags & CELL_RAW_ENCODED)) {
+                err = writeToOutput(output, cell->raw, cell->rawSize);
+            } else {
+                char *out;
+                if ((out = reserveOutput(output, cell->size, &err)) == NULL) {
+                    break;
+                }
+
+                // Borders and escape chars are skipped (raw data have been already checked while loading)
+                int prevC = '\0';
+                for (unsigned k = 0; k < cell->rawSize; k++) {
+                    int c = (unsigned char)cell->raw[k];
+                    if (!isEncodingChar(c, prevC)) {
+                        *out++ = (char)c;
+                    }
+
+                    prevC = c;
+                }
+                output->size += cell->size;
+            }
+
+            if (!err.error) {
+                err = evictRows(table);
+            }
+        }
+    }
+
+    return err;
+}
+
+/**
+ * Detects compression of the file by magic bytes at its start
+ * Only files which can be read at any position (regular files) are detected, other ones are taken as uncompressed.
+ * @param file Opened file (nothing has been read from it yet)
+ * @return Compression format (COMPRESSION_* constant)
+ */
+int detectCompression(FILE *file) {
+    unsigned char magic[4];
+    ssize_t size = pread(fileno(file), magic, sizeof(magic), 0);
+    if (size >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        return COMPRESSION_GZIP;
+    } else if (size >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+        return COMPRESSION_ZSTD;
+    }
+
+    return COMPRESSION_NONE;
+}
+
+/**
+ * Gets compression of the file by the extension of its name (.gz or .zst)
+ * @param path Path to the file
+ * @return Compression format (COMPRESSION_* constant)
+ */
+int getCompressionByName(const char *path) {
+    size_t length = strlen(path);
+    if (length > strlen(".gz") && streq(path + length - strlen(".gz"), ".gz")) {
+        return COMPRESSION_GZIP;
+    } else if (length > strlen(".zst") && streq(path + length - strlen(".zst"), ".zst")) {
+        return COMPRESSION_ZSTD;
+    }
+
+    return COMPRESSION_NONE;
+}
+
+/**
+ * Starts a process which decompresses data of the file or compresses data into it (gzip or zstd program is used)
+ * The process runs in parallel with sps, data are passed to it (or from it) through a pipe.
+ * @param compression Compression format (COMPRESSION_GZIP or COMPRESSION_ZSTD)
+ * @param descriptor File descriptor of the compressed file (read while decompressing, written while compressing)
+ * @param compress Are the data compressed into the file? (they're decompressed from it otherwise)
+ * @param process Output parameter for ID of the started process
+ * @return Stream of uncompressed data (for reading while decompressing, for writing while compressing) or NULL
+ * if error occurred
+ */
+FILE *openCompressionFilter(int compression, int descriptor, bool compress, pid_t *process) {
+    int ends[2];
+    if (pipe(ends) != 0) {
+        return NULL;
+    }
+
+    if ((*process = fork()) == -1) {
+        close(ends[0]);
+        close(ends[1]);
+        return NULL;
+    }
+
+    // The process reads from the file and writes into the pipe (or the other way round while compressing)
+    if (*process == 0) {
+        // (ends of the pipe may already be the standard descriptors when the standard input was closed)
+        dup2(compress ? ends[0] : descriptor, STDIN_FILENO);
+        dup2(compress ? descriptor : ends[1], STDOUT_FILENO);
+        for (int i = 0; i < 2; i++) {
+            if (ends[i] != STDIN_FILENO && ends[i] != STDOUT_FILENO) {
+                close(ends[i]);
+            }
+        }
+
+        const char *program = (compression == COMPRESSION_GZIP ? "gzip" : "zstd");
+        execlp(program, program, (compress ? "-c" : "-dc"), "-q", (char *)NULL);
+        _exit(127);
+    }
+
+    // This process uses the other end of the pipe
+    close(compress ? ends[0] : ends[1]);
+    int end = (compress ? ends[1] : ends[0]);
+    fcntl(end, F_SETFD, FD_CLOEXEC);
+
+    FILE *stream;
+    if ((stream = fdopen(end, compress ? "w" : "r")) == NULL) {
+        close(end);
+        waitpid(*process, NULL, 0);
+        return NULL;
+    }
+
+    return stream;
+}
+
+/**
+ * Waits for the end of the compressing (or decompressing) process
+ * Missing program is reported the same way as its failure (the process exits with code 127 then), so truncated or
+ * empty output of the process is never taken as valid data.
+ * @param process ID of the process
+ * @return Has been the process successful?
+ */
+bool waitForCompressionFilter(pid_t process) {
+    int status;
+    if (waitpid(process, &status, 0) != process) {
+        return false;
+    }
+
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/**
+ * Closes the stream of the compressing (or decompressing) process and waits for its end
+ * @param stream Stream of uncompressed data
+ * @param process ID of the process
+ * @return Has been the process successful?
+ */
+bool closeCompressionFilter(FILE *stream, pid_t process) {
+    bool success = (fclose(stream) == 0);
+
+    return waitForCompressionFilter(process) && success;
+}
+
+/**
+ * Flushes the file and the directory with it to the disk (so the file can't be lost after renaming)
+ * @param path Path to the file
+ * @return Has been the directory flushed?
+ */
+bool syncParentDirectory(const char *path) {
+    // Path of the directory is everything before the last slash
+    const char *slash = strrchr(path, '/');
+    char *directory;
+    if ((directory = malloc((slash != NULL ? (size_t)(slash - path) + 2 : 2) * sizeof(char))) == NULL) {
+        return false;
+    }
+    if (slash == NULL) {
+        strcpy(directory, ".");
+    } else {
+        memcpy(directory, path, (size_t)(slash - path) + 1);
+        directory[slash - path + 1] = '\0';
+    }
+
+    int fd = open(directory, O_RDONLY);
+    free(directory);
+    if (fd == -1) {
+        return false;
+    }
+
+    bool success = (fsync(fd) == 0);
+    close(fd);
+
+    return success;
+}
+
+/**
+ * Creates buffer for data saved into the file
+ * Output can be compared with the original data of the file. Nothing is written into the file until a difference
+ * is found (the same beginning of the data is written at once then), so the same output isn't written at all.
+ * Differences which don't change size of the data can be patched in the original file instead (they're kept until
+ * the whole output is compared). Patching isn't atomic (the file is changed in place, so it's partially patched, if
+ * writing of the patches fails), so it's used only when it's allowed by its descriptor.
+ * Filled buffers are written by a writer thread (if it can be created), so the data are written while the next
+ * buffer is being filled.
+ * Buffer without file keeps all data in memory (in filled blocks), until they're passed to another output buffer.
+ * Compared output can be written into a deferred output file instead, which is opened at the first difference (so
+ * nothing is opened, if the output is the same).
+ * <strong>Warning! The file mustn't be written through its FILE structure while the buffer is used</strong>
+ * @param file The file to save data into (opened for writing), NULL for keeping data in memory or for the deferred
+ *             output file
+ * @param original Original data the output is compared with (NULL if the output isn't compared)
+ * @param originalSize Size of the original data
+ * @param patchDescriptor File descriptor of the original file opened for writing (-1 if it mustn't be patched, then
+ *                        all differences are written into the file of the output buffer)
+ * @param originalDescriptor File descriptor of the original file opened for reading (-1 if the same data aren't
+ *                           copied by the kernel)
+ * @param required Must be the output written even if it's the same as the original data? (the output file isn't
+ *                 the original one)
+ * @param deferred Output file opened at the first difference (NULL if the file is given, the output must be compared
+ *                 with the original data otherwise)
+ * @return Output buffer or NULL if error occurred
+ */
+OutputBuffer *createOutputBuffer(FILE *file, const char *original, size_t originalSize, int patchDescriptor,
+                                 int originalDescriptor, bool required, DeferredOutput *deferred) {
+    OutputBuffer *output;
+    if ((output = malloc(sizeof(OutputBuffer))) == NULL) {
+        return NULL;
+    }
+
+    // Allocate buffers (one is filled, the other ones are spare)
+    output->sparesCount = 0;
+    bool writing = (file != NULL || deferred != NULL);
+    for (unsigned i = 0; i < (writing ? OUTPUT_BUFFERS_COUNT : 1); i++) {
+        char *data;
+        if ((data = malloc(OUTPUT_BUFFER_SIZE * sizeof(char))) == NULL) {
+            for (unsigned j = 0; j < output->sparesCount; j++) {
+                free(output->spares[j].data);
+            }
+            free(output);
+            return NULL;
+        }
+
+        output->spares[output->sparesCount++] = (OutputBlock){.data = data, .size = 0, .capacity = OUTPUT_BUFFER_SIZE};
+    }
+    output->data = output->spares[--output->sparesCount].data;
+
+    // Data written before through the FILE structure are written at first
+    output->descriptor = -1;
+    if (file != NULL) {
+        fflush(file);
+        output->descriptor = fileno(file);
+    }
+    output->size = 0;
+    output->capacity = OUTPUT_BUFFER_SIZE;
+    output->written = 0;
+    output->passed = 0;
+    output->original = original;
+    output->originalSize = originalSize;
+    output->originalData = original;
+    output->originalDescriptor = originalDescriptor;
+    output->required = required;
+    output->changed = (original == NULL);
+    output->patchDescriptor = patchDescriptor;
+    output->patches = NULL;
+    output->patchesCount = 0;
+    output->patchesCapacity = 0;
+    output->patchesData = NULL;
+    output->patchesSize = 0;
+    output->patched = false;
+    output->blocks = NULL;
+    output->blocksCount = 0;
+    output->blocksCapacity = 0;
+    output->deferred = deferred;
+
+    // Start the writer thread
+    output->queueStart = 0;
+    output->queueCount = 0;
+    output->stopping = false;
+    output->writerError.error = false;
+    output->threaded = false;
+    if (writing && pthread_mutex_init(&output->lock, NULL) == 0) {
+        if (pthread_cond_init(&output->signal, NULL) == 0) {
+            output->threaded = (pthread_create(&output->writer, NULL, runOutputWriter, output) == 0);
+            if (!output->threaded) {
+                pthread_cond_destroy(&output->signal);
+            }
+        }
+        if (!output->threaded) {
+            pthread_mutex_destroy(&output->lock);
+        }
+    }
+
+    return output;
+}
+
+/**
+ * Writes data through the output buffer
+ * Data bigger than the buffer are written directly (after data in the buffer are written), the other ones are copied
+ * into the buffer.
+ * @param output Output buffer
+ * @param data Data to write
+ * @param size Size of the data
+ * @return Error information
+ */
+ErrorInfo writeToOutput(OutputBuffer *output, const char *data, size_t size) {
+    ErrorInfo err = {.error = false};
+
+    // Small data are only copied into the buffer (empty cells have no data at all)
+    if (size == 0) {
+        return err;
+    } else if (output->size + size <= output->capacity) {
+        memcpy(output->data + output->size, data, size);
+        output->size += size;
+
+        return err;
+    }
+
+    // The next buffer can have a different size (buffers are resized for extra big cells), data kept in memory are
+    // always copied
+    if ((err = flushOutput(output)).error) {
+        return err;
+    }
+    if (size < output->capacity || (output->deferred == NULL && output->descriptor == -1)) {
+        char *out;
+        if ((out = reserveOutput(output, size, &err)) == NULL) {
+            return err;
+        }
+
+        memcpy(out, data, size);
+        output->size += size;
+
+        return err;
+    }
+
+    // Big data aren't copied, so they're written here (the writer thread doesn't work with the output meanwhile)
+    if ((err = waitForOutputWriter(output)).error) {
+        return err;
+    }
+
+    struct iovec parts[1] = {{.iov_base = (void *)data, .iov_len = size}};
+    if ((err = writeOutputParts(output, parts, 1)).error) {
+        return err;
+    }
+    output->passed += (off_t)size;
+
+    return err;
+}
+
+/**
+ * Writes parts of data into the file of the output buffer (or compares them with the original data)
+ * @param output Output buffer
+ * @param parts Parts of data to write (they're changed while writing)
+ * @param count Number of the parts
+ * @return Error information
+ */
+ErrorInfo writeOutputParts(OutputBuffer *output, struct iovec *parts, unsigned int count) {
+    ErrorInfo err = {.error = false};
+
+    // Parts which are the same as the original data are only skipped (data copied from the original ones aren't
+    // even compared), different parts of the same size are kept as patches of the original file, if it's possible
+    unsigned first = 0;
+    while (!output->changed && first < count) {
+        const char *original = output->original + output->written;
+        size_t rest = output->originalSize - (size_t)output->written;
+        if (parts[first].iov_len > rest
+            || (parts[first].iov_base != original && memcmp(parts[first].iov_base, original, parts[first].iov_len)
+                && !addOutputPatch(output, parts[first].iov_base, original, parts[first].iov_len))) {
+            output->changed = true;
+
+            break;
+        }
+
+        output->written += (off_t)parts[first].iov_len;
+        first++;
+    }
+
+    // The same beginning is written before the first different part (it's copied from the original data, with
+    // patches found in it), the deferred output file is opened for it
+    if (output->changed && output->original != NULL) {
+        if ((output->deferred != NULL && (err = openDeferredOutput(output->deferred, &output->descriptor)).error)
+            || (err = copyOriginalToOutput(output, output->original, (size_t)output->written)).error
+            || (err = writeOutputPatches(output, output->descriptor)).error) {
+            return err;
+        }
+        output->original = NULL;
+    }
+
+    // Parts of the original data are copied (by the kernel, if it's possible), partially written data are written
+    // again
+    while (first < count) {
+        const char *base = parts[first].iov_base;
+        if (output->originalData != NULL && base >= output->originalData
+            && base + parts[first].iov_len <= output->originalData + output->originalSize) {
+            if ((err = copyOriginalToOutput(output, base, parts[first].iov_len)).error) {
+                return err;
+            }
+
+            output->written += (off_t)parts[first].iov_len;
+            first++;
+
+            continue;
+        }
+
+
+        ssize_t written;
+        if ((written = writev(output->descriptor, parts + first, (int)(count - first))) < 0) {
+            err.error = true;
+            err.message = "Nepodarilo se zapsat tabulku do souboru.";
+
+            return err;
+        }
+
+        output->written += written;
+        while (first < count && (size_t)written >= parts[first].iov_len) {
+            written -= (ssize_t)parts[first].iov_len;
+            first++;
+        }
+        if (first < count) {
+            parts[first].iov_base = (char *)parts[first].iov_base + written;
+            parts[first].iov_len -= (size_t)written;
+        }
+    }
+
+    return err;
+}
+
+/**
+ * Writes data of the original file into the output file
+ * Data are copied from the original file by the kernel (they don't go through the process), if it's possible,
+ * otherwise they're written from the mapped original file.
+ * @param output Output buffer
+ * @param data Data in the original data of the output buffer
+ * @param size Size of the data
+ * @return Error information
+ */
+ErrorInfo copyOriginalToOutput(OutputBuffer *output, const char *data, size_t size) {
+    ErrorInfo err = {.error = false};
+
+    size_t done = 0;
+#ifdef KERNEL_COPYING
+    // Copying isn't supported by all types of files (the rest of the data is written from memory then)
+    if (output->originalDescriptor != -1) {
+        off_t offset = (off_t)(data - output->originalData);
+        while (done < size) {
+            ssize_t copied;
+            if ((copied = sendfile(output->descriptor, output->originalDescriptor, &offset, size - done)) <= 0) {
+                break;
+            }
+
+            done += (size_t)copied;
+        }
+    }
+#endif
+
+    while (done < size) {
+        ssize_t written;
+        if ((written = write(output->descriptor, data + done, size - done)) < 0) {
+            err.error = true;
+            err.message = "Nepodarilo se zapsat tabulku do souboru.";
+
+            return err;
+        }
+
+        done += (size_t)written;
+    }
+
+    return err;
+}
+
+/**
+ * Adds different part of the output to patches of the original file
+ * Only the changed range of the part is kept. Patches aren't added if the original file can't be patched or if
+ * they'd be too big.
+ * @param output Output buffer
+ * @param data Different data of the output
+ * @param original Original data at the same position
+ * @param size Size of the data
+ * @return Has the patch been added?
+ */
+bool addOutputPatch(OutputBuffer *output, const char *data, const char *original, size_t size) {
+    if (output->patchDescriptor == -1) {
+        return false;
+    }
+
+    // Find the changed range
+    size_t start = 0;
+    while (data[start] == original[start]) {
+        start++;
+    }
+    size_t end = size;
+    while (data[end - 1] == original[end - 1]) {
+        end--;
+    }
+    if (output->patchesSize + (end - start) > OUTPUT_PATCHES_LIMIT) {
+        return false;
+    }
+
+    // Resize the arrays, if it's necessary
+    if (output->patchesCount == output->patchesCapacity) {
+        unsigned capacity = output->patchesCapacity == 0 ? 16 : output->patchesCapacity * 2;
+        OutputPatch *patches;
+        if ((patches = realloc(output->patches, capacity * sizeof(OutputPatch))) == NULL) {
+            return false;
+        }
+
+        output->patches = patches;
+        output->patchesCapacity = capacity;
+    }
+    char *patchesData;
+    if ((patchesData = realloc(output->patchesData, output->patchesSize + (end - start))) == NULL) {
+        return false;
+    }
+    output->patchesData = patchesData;
+
+    // Save the patch
+    memcpy(output->patchesData + output->patchesSize, data + start, end - start);
+    output->patches[output->patchesCount++] = (OutputPatch){
+            .offset = output->written + (off_t)start, .size = end - start
+    };
+    output->patchesSize += end - start;
+
+    return true;
+}
+
+/**
+ * Writes patches of the original file into a file (at their positions) and removes them from the output buffer
+ * @param output Output buffer
+ * @param descriptor File descriptor of the patched file
+ * @return Error information
+ */
+ErrorInfo writeOutputPatches(OutputBuffer *output, int descriptor) {
+    ErrorInfo err = {.error = false};
+
+    char *data = output->patchesData;
+    for (unsigned i = 0; i < output->patchesCount && !err.error; i++) {
+        size_t done = 0;
+        while (done < output->patches[i].size) {
+            ssize_t written;
+            if ((written = pwrite(descriptor, data + done, output->patches[i].size - done,
+                                  output->patches[i].offset + (off_t)done)) < 0) {
+                err.error = true;
+                err.message = "Nepodarilo se zapsat tabulku do souboru.";
+
+                break;
+            }
+
+            done += (size_t)written;
+        }
+
+        data += output->patches[i].size;
+    }
+
+    free(output->patches);
+    free(output->patchesData);
+    output->patches = NULL;
+    output->patchesData = NULL;
+    output->patchesCount = 0;
+    output->patchesCapacity = 0;
+    output->patchesSize = 0;
+
+    return err;
+}
+
+/**
+ * Reserves space at the end of the output buffer (the caller writes data into it and increases size of the buffer)
+ * @param output Output buffer
+ * @param size Size of the space
+ * @param err Output parameter for error information
+ * @return Pointer to the reserved space or NULL if error occurred
+ */
+char *reserveOutput(OutputBuffer *output, size_t size, ErrorInfo *err) {
+    if (output->size + size > output->capacity) {
+        if ((*err = flushOutput(output)).error) {
+            return NULL;
+        }
+
+        // The buffer is resized only for extra big cells (buffer which keeps data in memory is allocated here after
+        // its filled block has been kept)
+        if (size > output->capacity) {
+            size_t capacity = (size > OUTPUT_BUFFER_SIZE ? size : OUTPUT_BUFFER_SIZE);
+            char *data;
+            if ((data = realloc(output->data, capacity * sizeof(char))) == NULL) {
+                err->error = true;
+                err->message = "Nepodarilo se alokovat pamet pro zapis tabulky.";
+
+                return NULL;
+            }
+
+            output->data = data;
+            output->capacity = capacity;
+        }
+    }
+
+    return output->data + output->size;
+}
+
+/**
+ * Writes all data from the output buffer into its file
+ * Data are passed to the writer thread (a spare buffer is used for the next data), if it runs.
+ * @param output Output buffer
+ * @return Error information (errors of the writer thread are reported later, not only by the call which passed the
+ * data)
+ */
+ErrorInfo flushOutput(OutputBuffer *output) {
+    ErrorInfo err = {.error = false};
+
+    if (output->size == 0) {
+        return err;
+    }
+
+    // Data kept in memory are moved into a filled block
+    if (output->deferred == NULL && output->descriptor == -1) {
+        return keepOutputBlock(output);
+    }
+
+    if (!output->threaded) {
+        struct iovec parts[1] = {{.iov_base = output->data, .iov_len = output->size}};
+        if ((err = writeOutputParts(output, parts, 1)).error) {
+            return err;
+        }
+        output->passed += (off_t)output->size;
+        output->size = 0;
+
+        return err;
+    }
+
+    // Add the buffer into the queue and wait for a spare one (the writer thread always returns buffers, even after
+    // an error)
+    pthread_mutex_lock(&output->lock);
+    while (output->queueCount == OUTPUT_BUFFERS_COUNT) {
+        pthread_cond_wait(&output->signal, &output->lock);
+    }
+    output->queue[(output->queueStart + output->queueCount) % OUTPUT_BUFFERS_COUNT] = (OutputBlock){
+            .data = output->data, .size = output->size, .capacity = output->capacity
+    };
+    output->queueCount++;
+    pthread_cond_broadcast(&output->signal);
+    while (output->sparesCount == 0) {
+        pthread_cond_wait(&output->signal, &output->lock);
+    }
+
+    OutputBlock spare = output->spares[--output->sparesCount];
+    err = output->writerError;
+    pthread_mutex_unlock(&output->lock);
+
+    output->data = spare.data;
+    output->capacity = spare.capacity;
+    output->passed += (off_t)output->size;
+    output->size = 0;
+
+    return err;
+}
+
+/**
+ * Writes blocks from the queue of the output buffer (function of the writer thread)
+ * @param outputPointer Output buffer
+ * @return NULL
+ */
+void *runOutputWriter(void *outputPointer) {
+    OutputBuffer *output = outputPointer;
+
+    pthread_mutex_lock(&output->lock);
+    while (true) {
+        while (output->queueCount == 0 && !output->stopping) {
+            pthread_cond_wait(&output->signal, &output->lock);
+        }
+        if (output->queueCount == 0) {
+            break;
+        }
+
+        // The block is written without the lock (state of the output buffer used by writing is used only here)
+        OutputBlock block = output->queue[output->queueStart];
+        bool failed = output->writerError.error;
+        pthread_mutex_unlock(&output->lock);
+
+        ErrorInfo err = {.error = false};
+        if (!failed) {
+            struct iovec parts[1] = {{.iov_base = block.data, .iov_len = block.size}};
+            err = writeOutputParts(output, parts, 1);
+        }
+
+        // Return the buffer (buffers passed from other output buffers are freed, if there are enough spare ones)
+        pthread_mutex_lock(&output->lock);
+        if (err.error) {
+            output->writerError = err;
+        }
+        output->queueStart = (output->queueStart + 1) % OUTPUT_BUFFERS_COUNT;
+        output->queueCount--;
+        if (output->sparesCount < OUTPUT_BUFFERS_COUNT) {
+            output->spares[output->sparesCount++] = block;
+        } else {
+            free(block.data);
+        }
+        pthread_cond_broadcast(&output->signal);
+    }
+    pthread_mutex_unlock(&output->lock);
+
+    return NULL;
+}
+
+/**
+ * Waits until the writer thread writes all queued blocks
+ * @param output Output buffer
+ * @return Error information of the writer thread
+ */
+ErrorInfo waitForOutputWriter(OutputBuffer *output) {
+    ErrorInfo err = {.error = false};
+
+    if (!output->threaded) {
+        return err;
+    }
+
+    pthread_mutex_lock(&output->lock);
+    while (output->queueCount > 0) {
+        pthread_cond_wait(&output->signal, &output->lock);
+    }
+    err = output->writerError;
+    pthread_mutex_unlock(&output->lock);
+
+    return err;
+}
+
+/**
+ * Stops the writer thread after it writes all queued blocks (the following data are written directly)
+ * @param output Output buffer
+ * @return Error information of the writer thread
+ */
+ErrorInfo stopOutputWriter(OutputBuffer *output) {
+    ErrorInfo err = {.error = false};
+
+    if (!output->threaded) {
+        return err;
+    }
+
+    pthread_mutex_lock(&output->lock);
+    output->stopping = true;
+    pthread_cond_broadcast(&output->signal);
+    pthread_mutex_unlock(&output->lock);
+
+    pthread_join(output->writer, NULL);
+    pthread_cond_destroy(&output->signal);
+    pthread_mutex_destroy(&output->lock);
+    output->threaded = false;
+
+    return output->writerError;
+}
+
+/**
+ * Passes all data of the buffer which keeps them in memory to the output buffer (its buffers are moved to the writer
+ * thread, so the data aren't copied)
+ * @param output Output buffer
+ * @param source Buffer with data kept in memory (it's empty after passing)
+ * @return Error information
+ */
+ErrorInfo passOutputBlocks(OutputBuffer *output, OutputBuffer *source) {
+    ErrorInfo err = {.error = false};
+
+    // Data in the buffer are written at first, the filled buffer of the source is its last block
+    if ((err = flushOutput(output)).error || (err = flushOutput(source)).error) {
+        return err;
+    }
+
+    unsigned i = 0;
+    for (; i < source->blocksCount && !err.error; i++) {
+        OutputBlock block = source->blocks[i];
+        output->passed += (off_t)block.size;
+
+        if (!output->threaded) {
+            struct iovec parts[1] = {{.iov_base = block.data, .iov_len = block.size}};
+            err = writeOutputParts(output, parts, 1);
+            free(block.data);
+
+            continue;
+        }
+
+        pthread_mutex_lock(&output->lock);
+        while (output->queueCount == OUTPUT_BUFFERS_COUNT) {
+            pthread_cond_wait(&output->signal, &output->lock);
+        }
+        output->queue[(output->queueStart + output->queueCount) % OUTPUT_BUFFERS_COUNT] = block;
+        output->queueCount++;
+        pthread_cond_broadcast(&output->signal);
+        err = output->writerError;
+        pthread_mutex_unlock(&output->lock);
+    }
+
+    // Blocks which haven't been passed because of an error are freed
+    for (; i < source->blocksCount; i++) {
+        free(source->blocks[i].data);
+    }
+    source->blocksCount = 0;
+
+    return err;
+}
+
+/**
+ * Moves data of the buffer which keeps them in memory into a filled block (a new buffer is allocated for the next data
+ * when they come)
+ * @param output Buffer with data kept in memory
+ * @return Error information
+ */
+ErrorInfo keepOutputBlock(OutputBuffer *output) {
+    ErrorInfo err = {.error = false};
+
+    // Resize the array of blocks, if it's necessary
+    if (output->blocksCount == output->blocksCapacity) {
+        unsigned capacity = (output->blocksCapacity == 0 ? 4 : 2 * output->blocksCapacity);
+        OutputBlock *blocks;
+        if ((blocks = realloc(output->blocks, capacity * sizeof(OutputBlock))) == NULL) {
+            err.error = true;
+            err.message = "Nepodarilo se alokovat pamet pro zapis tabulky.";
+
+            return err;
+        }
+
+        output->blocks = blocks;
+        output->blocksCapacity = capacity;
+    }
+
+    output->blocks[output->blocksCount++] = (OutputBlock){
+            .data = output->data, .size = output->size, .capacity = output->capacity
+    };
+    output->passed += (off_t)output->size;
+    output->data = NULL;
+    output->size = 0;
+    output->capacity = 0;
+
+    return err;
+}
+
+/**
+ * Writes the rest of data from the output buffer into its file
+ * Compared output which is shorter than the original data is written at once now (it's different from them), the same
+ * output is written too, if it's required.
+ * Compared output which differs only in patches is written into the original file (by the patches) instead.
+ * <strong>Warning! The original file isn't replaced atomically then, a failure while the patches are written (for ex.
+ * a crash or a full disk) leaves it partially patched.</strong>
+ * @param output Output buffer
+ * @return Error information
+ */
+ErrorInfo finishOutput(OutputBuffer *output) {
+    ErrorInfo err = {.error = false};
+
+    if ((err = flushOutput(output)).error || (err = stopOutputWriter(output)).error) {
+        return err;
+    }
+
+    if (!output->changed && (output->required || (size_t)output->written != output->originalSize)) {
+        output->changed = true;
+        err = writeOutputParts(output, NULL, 0);
+    } else if (!output->changed && output->patchesCount > 0) {
+        output->patched = true;
+        if (!(err = writeOutputPatches(output, output->patchDescriptor)).error && fsync(output->patchDescriptor) != 0) {
+            err.error = true;
+            err.message = "Zadany soubor se nepodarilo ulozit na disk.";
+        }
+    }
+
+    return err;
+}
+
+/**
+ * Destructs the output buffer (data which haven't been flushed are lost)
+ * @param output Output buffer to destruct
+ */
+void destructOutputBuffer(OutputBuffer *output) {
+    if (output == NULL) {
+        return;
+    }
+
+    // The writer thread must be stopped before its buffers are freed
+    stopOutputWriter(output);
+    free(output->data);
+    for (unsigned i = 0; i < output->sparesCount; i++) {
+        free(output->spares[i].data);
+    }
+    for (unsigned i = 0; i < output->blocksCount; i++) {
+        free(output->blocks[i].data);
+    }
+    free(output->blocks);
+    free(output->patches);
+    free(output->patchesData);
+    free(output);
+}
+
+/**
+ * Writes error message to standard error output
+ * @param message Error message
+ */
+void writeErrorMessage(const char *message) {
+    fprintf(stderr, "sps: %s\n", message);
+}
+
+/**
+ * Creates a set of column delimiters with precomputed classes of all chars
+ * @param chars Column delimiters (the first one is the main delimiter)
+ * @return Pointer to the new set of delimiters or NULL if error occurred
+ */
+DelimiterSet *createDelimiterSet(char *chars) {
+    DelimiterSet *delimiters;
+    if ((delimiters = malloc(sizeof(DelimiterSet))) == NULL) {
+        return NULL;
+    }
+
+    delimiters->chars = chars;
+    delimiters->length = (unsigned)strlen(chars);
+
+    // Set classes of chars
+    memset(delimiters->classes, 0, sizeof(delimiters->classes));
+    for (unsigned i = 0; i < delimiters->length; i++) {
+        delimiters->classes[(unsigned char)chars[i]] |= CHAR_CLASS_DELIMITER;
+    }
+    for (unsigned i = 0; i < strlen(SPECIAL_CHARS); i++) {
+        delimiters->classes[(unsigned char)SPECIAL_CHARS[i]] |= CHAR_CLASS_SPECIAL;
+    }
+    delimiters->classes['\n'] |= CHAR_CLASS_LINE_BREAK;
+
+    // '\0' has always been taken as delimiter (strchr() finds the string terminator, too)
+    delimiters->classes['\0'] |= CHAR_CLASS_DELIMITER;
+
+    return delimiters;
+}
+
+/**
+ * Destructs set of delimiters
+ * @param delimiters Set of delimiters to be destructed
+ */
+void destructDelimiterSet(DelimiterSet *delimiters) {
+    // Set of delimiters has been already destructed
+    if (delimiters == NULL) {
+        return;
+    }
+
+    free(delimiters);
+}
+
+/**
+ * Creates a new (empty) row index
+ * @param delimiters Column delimiters used in the indexed data
+ * @return Pointer to the new row index or NULL if error occurred
+ */
+RowIndex *createRowIndex(DelimiterSet *delimiters) {
+    RowIndex *index;
+    if ((index = malloc(sizeof(RowIndex))) == NULL) {
+        return NULL;
+    }
+
+    index->source = NULL;
+    index->sourceSize = 0;
+    index->delimiters = delimiters;
+    index->stride = ROW_INDEX_STRIDE;
+    index->size = 0;
+    index->width = 0;
+    index->offsets = NULL;
+    index->filledColumns = NULL;
+    index->capacity = 0;
+    index->canonical = false;
+    index->lastRow = 0;
+    index->lastPosition = NULL;
+
+    return index;
+}
+
+/**
+ * Adds the next row to the row index
+ * @param index Index to edit
+ * @param offset Offset of the row (it's used only for the first row of the block)
+ * @param filledColumns Number of the last non-empty column of the row
+ * @return Error information
+ */
+ErrorInfo addRowToIndex(RowIndex *index, uint64_t offset, unsigned int filledColumns) {
+    ErrorInfo err = {.error = false};
+
+    // The row starts a new block
+    unsigned block = index->size / index->stride;
+    if (index->size % index->stride == 0) {
+        // Resizing arrays of blocks if needed
+        if (index->capacity < (block + 1)) {
+            unsigned newCapacity = (index->capacity == 0 ? 1 : 2 * index->capacity);
+            uint64_t *offsets;
+            uint32_t *filled;
+            if ((offsets = realloc(index->offsets, newCapacity * sizeof(uint64_t))) != NULL) {
+                index->offsets = offsets;
+            }
+            if ((filled = realloc(index->filledColumns, newCapacity * sizeof(uint32_t))) != NULL) {
+                index->filledColumns = filled;
+            }
+            if (offsets == NULL || filled == NULL) {
+                err.error = true;
+                err.message = "Nepodarilo se rozsirit pametovy prostor pro index radku.";
+
+                return err;
+            }
+
+            index->capacity = newCapacity;
+        }
+
+        index->offsets[block] = offset;
+        index->filledColumns[block] = 0;
+    }
+
+    if (filledColumns > index->filledColumns[block]) {
+        index->filledColumns[block] = filledColumns;
+    }
+    index->size++;
+
+    return err;
+}
+
+/**
+ * Destructs row index
+ * @param index Row index to be destructed
+ */
+void destructRowIndex(RowIndex *index) {
+    // Row index has been already destructed
+    if (index == NULL) {
+        return;
+    }
+
+    free(index->offsets);
+    free(index->filledColumns);
+    free(index);
+}
+
+/**
+ * Creates a new cache for loaded rows
+ * @param budget Maximum memory for cells of the loaded rows (in bytes)
+ * @return Pointer to the new cache or NULL if error occurred
+ */
+PageCache *createPageCache(size_t budget) {
+    PageCache *cache;
+    if ((cache = malloc(sizeof(PageCache))) == NULL) {
+        return NULL;
+    }
+
+    // Scratch file is created when the first changed row is evicted
+    cache->index = NULL;
+    cache->scratch = NULL;
+    cache->scratchSize = 0;
+    cache->budget = budget;
+    cache->used = 0;
+    cache->newest = NULL;
+    cache->oldest = NULL;
+
+    return cache;
+}
+
+/**
+ * Destructs cache for loaded rows (rows must be already destructed)
+ * @param cache Cache to be destructed
+ */
+void destructPageCache(PageCache *cache) {
+    // Cache has been already destructed
+    if (cache == NULL) {
+        return;
+    }
+
+    // Scratch file is deleted automatically
+    if (cache->scratch != NULL) {
+        fclose(cache->scratch);
+    }
+
+    free(cache);
+}
+
+/**
+ * Creates a new arena (its blocks are allocated with the first allocations)
+ * @return Pointer to the new arena or NULL if error occurred
+ */
+Arena *createArena() {
+    Arena *arena;
+    if ((arena = malloc(sizeof(Arena))) == NULL) {
+        return NULL;
+    }
+
+    arena->blocks = NULL;
+    arena->last = NULL;
+
+    return arena;
+}
+
+/**
+ * Allocates memory from the arena (it's released only together with the arena)
+ * Allocations bigger than a quarter of the block get their own blocks, so the rest of the current block isn't wasted.
+ * @param arena Arena to allocate from
+ * @param size Size of the allocation (in bytes)
+ * @return Pointer to the allocated memory (aligned to ARENA_ALIGNMENT) or NULL if error occurred
+ */
+void *allocateFromArena(Arena *arena, size_t size) {
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+    // Allocation fits into the current block
+    ArenaBlock *block = arena->blocks;
+    if (block != NULL && block->size - block->used >= size) {
+        void *memory = block->data + block->used;
+        block->used += size;
+
+        return memory;
+    }
+
+    size_t blockSize = (size > ARENA_BLOCK_SIZE / 4 ? size : ARENA_BLOCK_SIZE);
+    if ((block = malloc(sizeof(ArenaBlock) + blockSize)) == NULL) {
+        return NULL;
+    }
+    block->size = blockSize;
+    block->used = size;
+
+    if (arena->blocks == NULL) {
+        // The first block of the arena
+        block->next = NULL;
+        arena->blocks = block;
+        arena->last = block;
+    } else if (blockSize != ARENA_BLOCK_SIZE) {
+        // Own block of the big allocation is put behind the current one (it's full anyway)
+        block->next = arena->blocks->next;
+        arena->blocks->next = block;
+        if (arena->last == arena->blocks) {
+            arena->last = block;
+        }
+    } else {
+        // New current block
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+
+    return block->data;
+}
+
+/**
+ * Moves all of the memory of the source arena into the arena (the source one is destructed)
+ * @param arena Arena to move the memory into
+ * @param source Arena to move the memory from
+ */
+void mergeArenas(Arena *arena, Arena *source) {
+    // Blocks of the source are appended behind the last block, so the current block of the arena stays the same
+    if (source->blocks != NULL) {
+        if (arena->blocks == NULL) {
+            arena->blocks = source->blocks;
+        } else {
+            arena->last->next = source->blocks;
+        }
+        arena->last = source->last;
+    }
+
+    free(source);
+}
+
+/**
+ * Destructs arena together with all of the memory allocated from it
+ * @param arena Arena to be destructed
+ */
+void destructArena(Arena *arena) {
+    // Arena has been already destructed
+    if (arena == NULL) {
+        return;
+    }
+
+    ArenaBlock *block = arena->blocks;
+    while (block != NULL) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+
+    free(arena);
+}
+
+/******************************************************************Functions for working with table and its components*/
+/**
+ * Creates a new table
+ * @param capacity How many rows can be in the table without resizing (at least 1)
+ * @param delimiters Column delimiters of the table's data
+ * @return Pointer to the new table or NULL if error occurred
+ */
+Table *createTable(unsigned int capacity, DelimiterSet *delimiters) {
+    Table *table;
+    if ((table = malloc(sizeof(Table))) == NULL) {
+        return NULL;
+    }
+
+    table->size = 0;
+    table->capacity = capacity;
+    table->index = NULL;
+    table->cache = NULL;
+    table->modifiedRow = NOT_MODIFIED_ROW;
+    table->delimiters = delimiters;
+    table->arena = NULL;
+    table->heap = NULL;
+    table->columns = NULL;
+    table->width = 0;
+    table->columnsCapacity = 0;
+    table->gap = NO_ROW_GAP;
+
+    if ((table->rows = malloc(capacity * sizeof(Row *))) == NULL) {
+        free(table);
+        return NULL;
+    }
+
+    return table;
+}
+
+/**
+ * Creates a new row
+ * @param capacity How many cells can be in the row without resizing (at least 1)
+ * @return Pointer to the new row or NULL if error occurred
+ */
+Row *createRow(unsigned int capacity) {
+    Row *row;
+    if ((row = malloc(sizeof(Row))) == NULL) {
+        return NULL;
+    }
+
+    row->size = 0;
+    row->capacity = capacity;
+    row->loaded = 0;
+    row->tail = NULL;
+    row->tailSize = 0;
+    row->tailFilled = 0;
+    row->tailCanonical = false;
+    row->tailDelimiters = NULL;
+    row->source = NULL;
+    row->sourceRow = NOT_INDEXED_ROW;
+    row->cache = NULL;
+    row->page = NULL;
+    row->spans = NULL;
+    row->heap = NULL;
+
+    if ((row->cells = malloc(capacity * sizeof(Cell *))) == NULL) {
+        free(row);
+        return NULL;
+    }
+
+    return row;
+}
+
+/**
+ * Creates a new row which will be loaded from indexed data when it's needed for the first time
+ * @param index Index of data with the row
+ * @param sourceRow Number of the row in the indexed data (indexed from 0)
+ * @return Pointer to the new row or NULL if error occurred
+ */
+Row *createIndexedRow(RowIndex *index, unsigned int sourceRow) {
+    Row *row;
+    if ((row = malloc(sizeof(Row))) == NULL) {
+        return NULL;
+    }
+
+    // All rows of the indexed data have the same number of cells
+    row->cells = NULL;
+    row->size = index->width;
+    row->capacity = 0;
+    row->loaded = 0;
+    row->tail = NULL;
+    row->tailSize = 0;
+    row->tailFilled = 0;
+    row->tailCanonical = false;
+    row->tailDelimiters = index->delimiters;
+    row->source = index;
+    row->sourceRow = sourceRow;
+    row->cache = NULL;
+    row->page = NULL;
+    row->spans = NULL;
+    row->heap = NULL;
+
+    return row;
+}
+
+/**
+ * Creates a new compact row (its cells are only spans of the heap)
+ * @param heap Heap with contents of the row's cells
+ * @param delimiters Column delimiters used in the input data of the row
+ * @param capacity How many cells can be in the row (at least 1), it can't be resized
+ * @return Pointer to the new row or NULL if error occurred
+ */
+Row *createCompactRow(char *heap, DelimiterSet *delimiters, unsigned int capacity) {
+    Row *row;
+    if ((row = malloc(sizeof(Row))) == NULL) {
+        return NULL;
+    }
+
+    row->cells = NULL;
+    row->size = 0;
+    row->capacity = 0;
+    row->loaded = 0;
+    row->tail = NULL;
+    row->tailSize = 0;
+    row->tailFilled = 0;
+    row->tailCanonical = false;
+    row->tailDelimiters = delimiters;
+    row->source = NULL;
+    row->sourceRow = NOT_INDEXED_ROW;
+    row->cache = NULL;
+    row->page = NULL;
+    row->heap = heap;
+
+    if ((row->spans = malloc(capacity * sizeof(CellSpan))) == NULL) {
+        free(row);
+        return NULL;
+    }
+
+    return row;
+}
+
+/**
+ * Creates a new cell
+ * @param arena Arena to allocate the cell from (NULL if the cell is allocated separately)
+ * @return Pointer to the new cell or NULL if error occurred
+ */
+Cell *createCell(Arena *arena) {
+    Cell *cell;
+    if ((cell = (arena != NULL ? allocateFromArena(arena, sizeof(Cell)) : malloc(sizeof(Cell)))) == NULL) {
+        return NULL;
+    }
+
+    // Data are allocated when the content is needed for the first time (see materializeCell())
+    cell->content.allocated.data = NULL;
+    cell->content.allocated.capacity = 0;
+    cell->raw = NULL;
+    cell->size = 0;
+    cell->rawSize = 0;
+    cell->flags = 0;
+    cell->inArena = (arena != NULL);
+    cell->dataInArena = false;
+    cell->shortContent = false;
+
+    return cell;
+}
+
+/**
+ * Adds a row to a table
+ * @param table Table to edit
+ * @param row Row to add to the table
+ * @param position Position in the table (1 = first)
+ * @return Error information
+ */
+ErrorInfo addRowToTable(Table *table, Row *row, unsigned int position) {
+    ErrorInfo err = {.error = false};
+
+    // Row behind the table (the selected row can be behind it after deleting rows) is added at its end, the same way
+    // as deleting of rows does
+    if (position > table->size + 1) {
+        position = table->size + 1;
+    }
+
+    // There are coordinates from the real world in row and column (indexed from 1) --> - 1
+    position--;
+
+    // Resizing table if needed (rows behind the gap would stay in the middle of the array)
+    if (table->capacity < (table->size + 1)) {
+        moveRowGap(table, table->size);
+        if ((table->rows = realloc(table->rows, table->capacity * 2 * sizeof(Row *))) == NULL) {
+            err.error = true;
+            err.message = "Nepodarilo se rozsirit pametovy prostor pro tabulku.";
+
+            return err;
+        }
+
+        // Columns of the columnar table have space for the same number of cells
+        for (unsigned j = 0; j < table->width; j++) {
+            Cell **cells;
+            if ((cells = realloc(table->columns[j].cells, table->capacity * 2 * sizeof(Cell *))) == NULL) {
+                err.error = true;
+                err.message = "Nepodarilo se rozsirit pametovy prostor pro tabulku.";
+
+                return err;
+            }
+
+            table->columns[j].cells = cells;
+        }
+
+        table->capacity *= 2;
+    }
+
+    // Free up space on specified position (the gap is moved there, so only rows between them are moved)
+    moveRowGap(table, position);
+
+    // The new row of the columnar table has empty cells (they're created when they're needed)
+    for (unsigned j = 0; j < table->width; j++) {
+        table->columns[j].cells[position] = NULL;
+    }
+
+    // Insert the row to the specified position (it's loaded into the table's cache, if there is any)
+    // The row is taken from the start of the gap
+    table->rows[position] = row;
+    table->size++;
+    table->gap = (position + 1 < table->size ? position + 1 : NO_ROW_GAP);
+    markRowAsModified(table, position);
+    row->cache = table->cache;
+
+    return err;
+}
+
+/**
+ * Adds a column to the table (inserts empty cell to all of the rows)
+ * @param table Table to edit
+ * @param position Position in the table (1 = first)
+ * @return Error information
+ */
+ErrorInfo addColumnToTable(Table *table, unsigned int position) {
+    ErrorInfo err = {.error = false};
+
+    // Column behind the table (the selected column can be behind it after deleting columns) is added at its end
+    if (table->columns != NULL && position > table->width + 1) {
+        position = table->width + 1;
+    }
+
+    // There are coordinates from the real world in row and column (indexed from 1) --> - 1
+    position--;
+
+    // Column of the columnar table is inserted at once (all of its cells are empty)
+    markRowAsModified(table, 0);
+    if (table->columns != NULL) {
+        if (table->width >= table->columnsCapacity) {
+            Column *columns;
+            if ((columns = realloc(table->columns, table->columnsCapacity * 2 * sizeof(Column))) == NULL) {
+                err.error = true;
+                err.message = "Nepodarilo se rozsirit pametovy prostor pro tabulku.";
+
+                return err;
+            }
+
+            table->columns = columns;
+            table->columnsCapacity *= 2;
+        }
+
+        Cell **cells;
+        if ((cells = calloc(table->capacity, sizeof(Cell *))) == NULL) {
+            err.error = true;
+            err.message = "Nepodarilo se alokovat pamet pro novy sloupec.";
+
+            return err;
+        }
+
+        memmove(table->columns + position + 1, table->columns + position,
+                (table->width - position) * sizeof(Column));
+        table->columns[position].cells = cells;
+        table->width++;
+
+        return err;
+    }
+
+    // Add cell to every row at specified position
+    for (unsigned i = 0; i < table->size; i++) {
+        Cell *cell;
+        if ((cell = createCell(table->arena)) == NULL) {
+            err.error = true;
+            err.message = "Nepodarilo se alokovat pamet pro novou bunku.";
+
+            return err;
+        }
+
+        if ((err = addCellToRow(getTableRow(table, i), cell, position + 1)).error) {
+            return err;
+        }
+
+        if ((err = evictRows(table)).error) {
+            return err;
+        }
+    }
+
+    return err;
+}
+
+/**
+ * Adds a cell to a row
+ * @param row Row to edit
+ * @param cell Cell to add to the row
+ * @param position Position in the row (1 = first)
+ * @return Error information
+ */
+ErrorInfo addCellToRow(Row *row, Cell *cell, unsigned int position) {
+    ErrorInfo err = {.error = false};
+
+    // There are coordinates from the real world in row and column (indexed from 1) --> - 1
+    position--;
+
+    // Cells can be added only to fully loaded row
+    if ((err = materializeRow(row, row->size)).error) {
+        return err;
+    }
+
+    // Cell behind the row is added at its end (rows are sized exactly to their cells)
+    if (position > row->size) {
+        position = row->size;
+    }
+
+    // Resizing the row if needed
+    if (row->capacity < (row->size + 1)) {
+        if ((row->cells = realloc(row->cells, row->capacity * 2 * sizeof(Cell *))) == NULL) {
+            err.error = true;
+            err.message = "Nepodarilo se rozsirit pametovy prostor pro radek.";
+
+            return err;
+        }
+
+        row->capacity *= 2;
+    }
+
+    // Free up the space on specified position
+    for (unsigned i = row->size; i > position; i--) {
+        row->cells[i] = row->cells[i - 1];
+    }
+
+    // Insert the cell to the specified position
+    row->cells[position] = cell;
+    row->size++;
+    row->loaded++;
+
+    return err;
+}
+
+/**
+ * Makes space for cells in the row at once (so adding cells up to the capacity doesn't need resizing)
+ * @param row Row to edit
+ * @param capacity Minimal number of cells that can be in the row
+ * @return Error information
+ */
+ErrorInfo reserveRowCapacity(Row *row, unsigned int capacity) {
+    ErrorInfo err = {.error = false};
+
+    // Space can be reserved only in fully loaded row
+    if ((err = materializeRow(row, row->size)).error) {
+        return err;
+    }
+
+    if (row->capacity >= capacity) {
+        return err;
+    }
+
+    Cell **cells;
+    if ((cells = realloc(row->cells, capacity * sizeof(Cell *))) == NULL) {
+        err.error = true;
+        err.message = "Nepodarilo se rozsirit pametovy prostor pro radek.";
+
+        return err;
+    }
+
+    row->cells = cells;
+    row->capacity = capacity;
+
+    return err;
+}
+
+/**
+ * Adds a char to the cell
+ * @param cell Cell to edit
+ * @param c Char to insert
+ * @param position Position in the cell (1 = first)
+ * @return Error information
+ */
+ErrorInfo addCharToCell(Cell *cell, char c, unsigned int position) {
+    ErrorInfo err = {.error = false};
+
+    // There are coordinates from the real world in row and column (indexed from 1) --> - 1
+    position--;
+
+    // The cell must have its own data for editing
+    if ((err = materializeCell(cell, NULL)).error) {
+        return err;
+    }
+
+    // Resize data for the cell if needed
+    unsigned capacity = (cell->shortContent ? CELL_SHORT_CAPACITY : cell->content.allocated.capacity);
+    if (capacity < (cell->size + 1)) {
+        // Short data and data from the arena can't be resized, they're copied into a new allocation
+        // The last '\0' --> + 1
+        bool owned = ownsCellData(cell);
+        char *data;
+        if ((data = realloc(owned ? cell->content.allocated.data : NULL, (2 * capacity + 1) * sizeof(char))) == NULL) {
+            err.error = true;
+            err.message = "Nepodarilo se rozsirit pametovy prostor pro bunku.";
+
+            return err;
+        }
+        if (!owned) {
+            memcpy(data, getCellData(cell), cell->size);
+            cell->dataInArena = false;
+        }
+
+        capacity *= 2;
+        cell->shortContent = false;
+        cell->content.allocated.data = data;
+        cell->content.allocated.capacity = capacity;
+    }
+
+    // Fill newly allocated space with zero bytes
+    char *data = getCellData(cell);
+    memset(&(data[cell->size]), '\0', capacity - cell->size + 1);
+
+    // Free up the space on specified position
+    for (unsigned i = cell->size; i > position; i--) {
+        data[i] = data[i - 1];
+    }
+
+    // Append char to the cell data (cell.size == last index + 1)
+    data[position] = c;
+    cell->size++;
+
+    // Content is different from the raw data now
+    cell->raw = NULL;
+    cell->rawSize = 0;
+    cell->flags &= ~CELL_RAW_ENCODED;
+
+    return err;
+}
+
+/**
+ * Copies content of the cell out of the input data (decodes its raw data into its own data)
+ * Cells which already have their own data are left unchanged
+ * @param cell Cell to edit
+ * @param arena Arena to allocate the data from (NULL if the data will be edited, so they must be allocated separately)
+ * @return Error information
+ */
+ErrorInfo materializeCell(Cell *cell, Arena *arena) {
+    ErrorInfo err = {.error = false};
+
+    // The cell has already had its own data
+    if (getCellData(cell) != NULL) {
+        return err;
+    }
+
+    // Short content is kept right in the cell
+    // The last '\0' --> + 1
+    unsigned capacity = (cell->size > CELL_START_CAPACITY ? cell->size : CELL_START_CAPACITY);
+    char *data;
+    if (capacity <= CELL_SHORT_CAPACITY) {
+        cell->shortContent = true;
+        arena = NULL;
+    } else if ((data = (arena != NULL ? allocateFromArena(arena, (capacity + 1) * sizeof(char))
+                                      : malloc((capacity + 1) * sizeof(char)))) == NULL) {
+        err.error = true;
+        err.message = "Nepodarilo se alokovat pamet pro obsah bunky.";
+
+        return err;
+    } else {
+        cell->content.allocated.data = data;
+        cell->content.allocated.capacity = capacity;
+    }
+    cell->dataInArena = (arena != NULL);
+
+    data = getCellData(cell);
+    copyCellContent(cell, data);
+    data[cell->size] = '\0';
+
+    return err;
+}
+
+/**
+ * Copies content of the cell view (decoded raw data of the cell) into the memory (without the last '\0')
+ * @param cell Cell view to copy the content of
+ * @param destination Memory with space for the content (cell->size chars)
+ */
+void copyCellContent(Cell *cell, char *destination) {
+    if (cell->flags & CELL_RAW_ENCODED) {
+        // Borders and escape chars are skipped (raw data have been already checked while loading)
+        unsigned size = 0;
+        int prevC = '\0';
+        for (unsigned i = 0; i < cell->rawSize; i++) {
+            int c = (unsigned char)cell->raw[i];
+            if (!isEncodingChar(c, prevC)) {
+                destination[size++] = (char)c;
+            }
+
+            prevC = c;
+        }
+    } else if (cell->size > 0) {
+        memcpy(destination, cell->raw, cell->size);
+    }
+}
+
+/**
+ * Returns the cell's own content (the short one is kept right in the cell, the longer one is allocated)
+ * @param cell Cell to get the content of
+ * @return Content of the cell or NULL if the cell is only a view into input data
+ */
+char *getCellData(Cell *cell) {
+    return (cell->shortContent ? cell->content.shortData : cell->content.allocated.data);
+}
+
+/**
+ * Checks if the cell's data have been allocated only for the cell (they aren't short data or data from the arena)
+ * @param cell Cell to check
+ * @return Can the data be resized and freed?
+ */
+bool ownsCellData(Cell *cell) {
+    return !cell->shortContent && cell->content.allocated.data != NULL && !cell->dataInArena;
+}
+
+/**
+ * Loads cells of the row which haven't been loaded yet (the row is found in the indexed data, if it's needed)
+ * @param row Row to load
+ * @param columns Number of cells that must be loaded (the rest of them can stay in the raw tail)
+ * @return Error information
+ */
+ErrorInfo materializeRow(Row *row, unsigned int columns) {
+    ErrorInfo err = {.error = false};
+
+    if (columns > row->size) {
+        columns = row->size;
+    }
+
+    // Compact row is needed with its cells (only its saving works with its spans)
+    if (row->spans != NULL && columns > 0) {
+        if ((err = expandCompactRow(row)).error) {
+            return err;
+        }
+    }
+
+    // Evicted row is loaded back from the scratch file
+    if (row->page != NULL && row->page->evicted) {
+        if ((err = loadEvictedRow(row)).error) {
+            return err;
+        }
+    }
 
-                        // Save the char
-                        (*param)[cmdI] = string[i];
-                        (*param)[cmdI + 1] = '\0';
-                    }
+    // The row from indexed data is loaded the same way as rows of the whole data (the data behind the row are cut off)
+    if (row->source != NULL) {
+        RowIndex *index = row->source;
+        const char *position = findIndexedRow(index, row->sourceRow);
+        const char *end = findIndexedRow(index, row->sourceRow + 1);
+        signed char flag = EMPTY_FLAG;
+        Row *loaded;
+        if ((loaded = loadRowFromMemory(&position, end, index->delimiters, (columns > 0 ? columns : 1), columns,
+                                        NULL, &flag)) == NULL || loaded->size > row->size) {
+            destructRow(loaded);
 
-                    i++;
-                }
+            err.error = true;
+            err.message = "Nepodarilo se nacist radek tabulky ze vstupniho souboru.";
 
-                if (string[i] == ';') {
-                    *flag = INVALID_INPUT_FORMAT;
+            return err;
+        }
 
-                    return NULL;
-                }
+        // Cells are moved into the row, so pointers to the row stay valid (the row stays in its cache)
+        unsigned size = row->size;
+        unsigned sourceRow = row->sourceRow;
+        PageCache *cache = row->cache;
+        RowPage *page = row->page;
+        free(row->cells);
+        *row = *loaded;
+        free(loaded);
+        row->sourceRow = sourceRow;
+        row->cache = cache;
+        row->page = page;
+
+        // Rows of data which aren't in the canonical form can be shorter than the others (they're aligned by empty
+        // cells the same way as while loading the whole data)
+        for (unsigned j = row->size; j < size; j++) {
+            Cell *cell;
+            if ((cell = createCell(NULL)) == NULL) {
+                err.error = true;
+                err.message = "Nepodarilo se alokovat pamet pro novou bunku.";
 
-                continue;
+                return err;
             }
 
-            // Skip ']' char at the end of selection commands
-            if (string[i] == ']' && (string[i + 1] == ' ' || string[i + 1] == ';' || string[i + 1] == '\0')) {
-                continue;
+            if ((err = addCellToRow(row, cell, j + 1)).error) {
+                destructCell(cell);
+                return err;
             }
+        }
+    }
 
-            // Data processing commands and named selection commands ([min], [max], [find STR], [set])
-            // Loading command name
-            if (paramI == 0) {
-                // Skip '[' char at the start of selection commands and set command type
-                if (cmdI == 0 && string[i] == '[') {
-                    cmd->type = SELECTION_COMMAND;
-                    continue;
-                }
+    // Cells are loaded from the raw tail (its format has been already checked)
+    if (row->loaded < columns && row->capacity < columns) {
+        Cell **cells;
+        if ((cells = realloc(row->cells, columns * sizeof(Cell *))) == NULL) {
+            err.error = true;
+            err.message = "Nepodarilo se rozsirit pametovy prostor pro radek.";
 
-                cmd->name[cmdI] = string[i];
-            } else {
-                // Skip escape char
-                if (string[i] == '\\' && string[i - 1] != '\\') {
-                    continue;
-                }
+            return err;
+        }
 
-                // Resize string parameters to cmd + 2 for the saving of the next char
-                // cmd + 2: indexing from 0 and space for '\0'
-                // [0] => name, [1] => firstParameter --> -1 (array with parameters start at index 0)
-                char **param = &(cmd->strParams[paramI - 1]);
-                char *tmp;
-                if ((tmp = realloc(*param, sizeof(char) * (cmdI + 2))) == NULL) {
-                    return NULL;
-                } else {
-                    *param = tmp;
-                }
+        row->cells = cells;
+        row->capacity = columns;
+    }
+    while (row->loaded < columns) {
+        const char *position = row->tail;
+        signed char flag = EMPTY_FLAG;
+        Cell *cell;
+        if ((cell = loadCellFromMemory(&position, row->tail + row->tailSize, row->tailDelimiters, NULL,
+                                       &flag)) == NULL) {
+            err.error = true;
+            err.message = "Nepodarilo se alokovat pamet pro novou bunku.";
 
-                // Save the char
-                (*param)[cmdI] = string[i];
-                (*param)[cmdI + 1] = '\0';
+            return err;
+        }
+
+        row->cells[row->loaded] = cell;
+        row->loaded++;
+        row->tailSize -= (unsigned)(position - row->tail);
+        row->tail = (row->loaded < row->size ? position : NULL);
+    }
+    if (row->tail == NULL) {
+        row->tailSize = 0;
+        row->tailFilled = 0;
+    }
+
+    // Loaded row of the cache is the most recently used one
+    return markRowAsUsed(row);
+}
+
+/**
+ * Marks the loaded row as the most recently used one in its cache
+ * @param row Row to mark (rows without cache are left unchanged)
+ * @return Error information
+ */
+ErrorInfo markRowAsUsed(Row *row) {
+    ErrorInfo err = {.error = false};
+
+    PageCache *cache = row->cache;
+    if (cache == NULL || cache->newest == row) {
+        return err;
+    }
+
+    // The row is moved to the start of the list of loaded rows
+    if (row->page == NULL) {
+        if ((row->page = malloc(sizeof(RowPage))) == NULL) {
+            err.error = true;
+            err.message = "Nepodarilo se alokovat pamet pro strankovani radku.";
+
+            return err;
+        }
+
+        row->page->listed = false;
+        row->page->evicted = false;
+        row->page->filled = 0;
+        row->page->slot = 0;
+        row->page->slotSize = 0;
+    } else {
+        unlistRow(row);
+    }
+
+    // Memory of the previous most recently used row could have been changed while it's been used
+    if (cache->newest != NULL) {
+        RowPage *previous = cache->newest->page;
+        cache->used -= previous->memory;
+        previous->memory = measureRowMemory(cache->newest);
+        cache->used += previous->memory;
+
+        previous->newer = row;
+    } else {
+        cache->oldest = row;
+    }
+
+    row->page->newer = NULL;
+    row->page->older = cache->newest;
+    row->page->memory = measureRowMemory(row);
+    row->page->listed = true;
+    cache->newest = row;
+    cache->used += row->page->memory;
+
+    return err;
+}
+
+/**
+ * Creates cells of the compact row (views into its heap, contents there are already decoded)
+ * The row stops being compact, its cells are edited the same way as cells of other rows.
+ * @param row Compact row to expand
+ * @return Error information
+ */
+ErrorInfo expandCompactRow(Row *row) {
+    ErrorInfo err = {.error = false};
+
+    // Space for the cells could have been already reserved (see reserveRowCapacity())
+    unsigned capacity = (row->capacity > row->size ? row->capacity : row->size);
+    Cell **cells;
+    if ((cells = malloc((capacity > 0 ? capacity : 1) * sizeof(Cell *))) == NULL) {
+        err.error = true;
+        err.message = "Nepodarilo se rozsirit pametovy prostor pro radek.";
+
+        return err;
+    }
+
+    for (unsigned j = 0; j < row->size; j++) {
+        if ((cells[j] = createCell(NULL)) == NULL) {
+            for (unsigned k = 0; k < j; k++) {
+                destructCell(cells[k]);
             }
+            free(cells);
 
-            // Increment command name/parameter string iteration var
-            cmdI++;
+            err.error = true;
+            err.message = "Nepodarilo se alokovat pamet pro novou bunku.";
+
+            return err;
         }
+
+        viewCompactCell(row, j, cells[j]);
     }
 
-    // Close the last command
-    addNewCmdToSeq(cmdSeq, cmd);
+    free(row->cells);
+    free(row->spans);
+    row->cells = cells;
+    row->capacity = (capacity > 0 ? capacity : 1);
+    row->loaded = row->size;
+    row->spans = NULL;
 
-    // Convert string to int types of parameters
-    convertTypesInCommandParams(cmdSeq);
+    return err;
+}
 
-    return cmdSeq;
+/**
+ * Fills the empty cell to be a view into the heap of the compact row (flags of its content are found out)
+ * @param row Compact row
+ * @param column Column of the cell in the row (indexed from 0)
+ * @param cell Empty cell to fill
+ */
+void viewCompactCell(Row *row, unsigned int column, Cell *cell) {
+    cell->raw = row->heap + row->spans[column].offset;
+    cell->rawSize = row->spans[column].size;
+    cell->size = row->spans[column].size;
+    for (unsigned k = 0; k < cell->size; k++) {
+        cell->flags |= getCharFlags(row->tailDelimiters, cell->raw[k]);
+    }
 }
 
 /**
- * Saves table data to the file
- * @param table Table to save
- * @param file The file to save the table into
- * @param delimiter Column delimiter
+ * Evicts the least recently used rows of the table's cache until the memory used by loaded rows fits into its budget
+ * Only the most recently used row is always kept loaded. <strong>Warning! Pointers to cells of other rows aren't valid
+ * after evicting.</strong>
+ * @param table Table to edit (tables without cache are left unchanged)
+ * @return Error information
  */
-void saveTableToFile(Table *table, FILE *file, char *delimiters) {
-    // Trim rows of the table
-    trimRows(table);
+ErrorInfo evictRows(Table *table) {
+    ErrorInfo err = {.error = false};
 
-    // Main delimiter
-    char mainDelimiter = delimiters[0];
+    PageCache *cache = table->cache;
+    if (cache == NULL) {
+        return err;
+    }
 
-    for (unsigned i = 0; i < table->size; i++) {
-        for (unsigned j = 0; j < table->rows[i]->size; j++) {
-            Cell *cell = table->rows[i]->cells[j];
+    while (cache->used > cache->budget && cache->oldest != cache->newest) {
+        if ((err = evictRow(cache, cache->oldest)).error) {
+            return err;
+        }
+    }
 
-            // Check if borders for cell contains delimiter are required
-            bool borders = false;
-            for (unsigned k = 0; k < strlen(delimiters); k++) {
-                if (strc(cell->data, delimiters[k])) {
-                    borders = true;
+    return err;
+}
 
-                    break;
-                }
-            }
+/**
+ * Evicts the loaded row from the cache
+ * Unchanged row is returned to the indexed data, changed one is saved into the scratch file (into its previous
+ * record, if the new one fits into it)
+ * @param cache Cache with the row
+ * @param row Row to evict
+ * @return Error information
+ */
+ErrorInfo evictRow(PageCache *cache, Row *row) {
+    ErrorInfo err = {.error = false};
 
-            // Print left border
-            if (borders) {
-                fputc('"', file);
-            }
+    unlistRow(row);
 
-            for (unsigned k = 0; k < cell->size; k++) {
-                // Add backslash before escaped characters
-                if (strc(SPECIAL_CHARS, cell->data[k])) {
-                    fputc('\\', file);
-                }
+    if (isRowUnchanged(row, cache->index)) {
+        for (unsigned i = 0; i < row->loaded; i++) {
+            destructCell(row->cells[i]);
+        }
+        free(row->cells);
+        free(row->page);
+
+        row->cells = NULL;
+        row->capacity = 0;
+        row->loaded = 0;
+        row->tail = NULL;
+        row->tailSize = 0;
+        row->tailFilled = 0;
+        row->tailCanonical = false;
+        row->tailDelimiters = cache->index->delimiters;
+        row->source = cache->index;
+        row->page = NULL;
 
-                // Print char from cell data
-                fputc(cell->data[k], file);
-            }
+        return err;
+    }
 
-            // Print right border
-            if (borders) {
-                fputc('"', file);
-            }
+    // Record of the row: number of cells and their properties (content is saved only for cells with their own data,
+    // other ones are views into the indexed data)
+    size_t recordSize = sizeof(unsigned);
+    for (unsigned i = 0; i < row->loaded; i++) {
+        Cell *cell = row->cells[i];
+        recordSize += sizeof(const char *) + 2 * sizeof(unsigned) + 2 * sizeof(unsigned char)
+                + (getCellData(cell) != NULL ? cell->size : 0);
+    }
 
-            // Add delimiter if not last
-            if (j + 1 < table->rows[i]->size) {
-                fputc(mainDelimiter, file);
+    char *record;
+    if ((record = malloc(recordSize)) == NULL) {
+        err.error = true;
+        err.message = "Nepodarilo se alokovat pamet pro vyrazeni radku z pameti.";
+
+        return err;
+    }
+
+    char *position = record;
+    memcpy(position, &(row->loaded), sizeof(unsigned));
+    position += sizeof(unsigned);
+    for (unsigned i = 0; i < row->loaded; i++) {
+        Cell *cell = row->cells[i];
+        unsigned char owned = (getCellData(cell) != NULL);
+        memcpy(position, &(cell->raw), sizeof(const char *));
+        position += sizeof(const char *);
+        memcpy(position, &(cell->rawSize), sizeof(unsigned));
+        position += sizeof(unsigned);
+        memcpy(position, &(cell->size), sizeof(unsigned));
+        position += sizeof(unsigned);
+        *position++ = (char)cell->flags;
+        *position++ = (char)owned;
+        if (owned) {
+            memcpy(position, getCellData(cell), cell->size);
+            position += cell->size;
+        }
+    }
+
+    // The scratch file is deleted automatically when it's closed
+    if (cache->scratch == NULL && (cache->scratch = tmpfile()) == NULL) {
+        free(record);
+
+        err.error = true;
+        err.message = "Nepodarilo se vytvorit docasny soubor pro vyrazene radky.";
+
+        return err;
+    }
+
+    RowPage *page = row->page;
+    if (recordSize > page->slotSize) {
+        page->slot = cache->scratchSize;
+        page->slotSize = recordSize;
+        cache->scratchSize += (off_t)recordSize;
+    }
+    if (pwrite(fileno(cache->scratch), record, recordSize, page->slot) != (ssize_t)recordSize) {
+        free(record);
+
+        err.error = true;
+        err.message = "Nepodarilo se zapsat radek do docasneho souboru.";
+
+        return err;
+    }
+    free(record);
+
+    page->filled = getFilledColumns(row);
+    page->evicted = true;
+    for (unsigned i = 0; i < row->loaded; i++) {
+        destructCell(row->cells[i]);
+    }
+    free(row->cells);
+    row->cells = NULL;
+    row->capacity = 0;
+    row->loaded = 0;
+
+    return err;
+}
+
+/**
+ * Loads cells of the evicted row back from the scratch file
+ * @param row Row to load
+ * @return Error information
+ */
+ErrorInfo loadEvictedRow(Row *row) {
+    ErrorInfo err = {.error = false};
+
+    RowPage *page = row->page;
+    char *record;
+    if ((record = malloc(page->slotSize)) == NULL) {
+        err.error = true;
+        err.message = "Nepodarilo se alokovat pamet pro nacteni vyrazeneho radku.";
+
+        return err;
+    }
+    if (pread(fileno(row->cache->scratch), record, page->slotSize, page->slot) != (ssize_t)page->slotSize) {
+        free(record);
+
+        err.error = true;
+        err.message = "Nepodarilo se nacist radek z docasneho souboru.";
+
+        return err;
+    }
+
+    // The record is read the same way as it's been written in evictRow()
+    const char *position = record;
+    unsigned loaded;
+    memcpy(&loaded, position, sizeof(unsigned));
+    position += sizeof(unsigned);
+    if ((row->cells = malloc((loaded > 0 ? loaded : 1) * sizeof(Cell *))) == NULL) {
+        free(record);
+
+        err.error = true;
+        err.message = "Nepodarilo se alokovat pamet pro nacteni vyrazeneho radku.";
+
+        return err;
+    }
+    row->capacity = (loaded > 0 ? loaded : 1);
+
+    for (unsigned i = 0; i < loaded; i++) {
+        Cell *cell;
+        if ((cell = createCell(NULL)) == NULL) {
+            free(record);
+
+            err.error = true;
+            err.message = "Nepodarilo se alokovat pamet pro novou bunku.";
+
+            return err;
+        }
+
+        memcpy(&(cell->raw), position, sizeof(const char *));
+        position += sizeof(const char *);
+        memcpy(&(cell->rawSize), position, sizeof(unsigned));
+        position += sizeof(unsigned);
+        memcpy(&(cell->size), position, sizeof(unsigned));
+        position += sizeof(unsigned);
+        cell->flags = (unsigned char)*position++;
+        bool owned = (*position++ != 0);
+        if (owned) {
+            // Short content is kept right in the cell
+            char *data;
+            if (cell->size <= CELL_SHORT_CAPACITY) {
+                cell->shortContent = true;
+            } else if ((data = malloc((cell->size + 1) * sizeof(char))) == NULL) {
+                destructCell(cell);
+                free(record);
+
+                err.error = true;
+                err.message = "Nepodarilo se alokovat pamet pro obsah bunky.";
+
+                return err;
+            } else {
+                cell->content.allocated.data = data;
+                cell->content.allocated.capacity = cell->size + 1;
             }
+
+            data = getCellData(cell);
+            memcpy(data, position, cell->size);
+            data[cell->size] = '\0';
+            position += cell->size;
         }
 
-        // Add line break
-        fputc('\n', file);
+        row->cells[i] = cell;
+        row->loaded++;
     }
+    free(record);
+
+    page->evicted = false;
+
+    return err;
 }
 
 /**
- * Writes error message to standard error output
- * @param message Error message
+ * Removes the row from the list of loaded rows of its cache (memory used by the row isn't counted anymore)
+ * @param row Row to remove (rows which aren't in the list are left unchanged)
  */
-void writeErrorMessage(const char *message) {
-    fprintf(stderr, "sps: %s\n", message);
+void unlistRow(Row *row) {
+    PageCache *cache = row->cache;
+    RowPage *page = row->page;
+    if (page == NULL || !page->listed) {
+        return;
+    }
+
+    if (page->newer != NULL) {
+        page->newer->page->older = page->older;
+    } else {
+        cache->newest = page->older;
+    }
+    if (page->older != NULL) {
+        page->older->page->newer = page->newer;
+    } else {
+        cache->oldest = page->newer;
+    }
+
+    cache->used -= page->memory;
+    page->listed = false;
 }
 
-/******************************************************************Functions for working with table and its components*/
 /**
- * Creates a new table
- * @return Pointer to the new table or NULL if error occurred
+ * Checks if the loaded row is the same as in the indexed data (it can be loaded from them again)
+ * Loaded cells must be views into the row in the indexed data (without gaps) and the other cells must be in the raw
+ * tail or they must be empty cells aligning the row to the table's size.
+ * @param row Row to check
+ * @param index Index of data the row has been loaded from
+ * @return Is the row unchanged?
  */
-Table *createTable() {
-    Table *table;
-    if ((table = malloc(sizeof(Table))) == NULL) {
-        return NULL;
+bool isRowUnchanged(Row *row, RowIndex *index) {
+    if (row->sourceRow == NOT_INDEXED_ROW || row->size != index->width) {
+        return false;
     }
 
-    table->size = 0;
-    table->capacity = TABLE_START_CAPACITY;
+    const char *expected = findIndexedRow(index, row->sourceRow);
+    const char *end = findIndexedRow(index, row->sourceRow + 1);
+    bool ended = false;
+    for (unsigned i = 0; i < row->loaded; i++) {
+        Cell *cell = row->cells[i];
+        if (cell->raw == NULL) {
+            // Only aligning cells can be behind the end of the row in the indexed data
+            if (!ended || getCellData(cell) != NULL) {
+                return false;
+            }
+        } else {
+            if (ended || cell->raw != expected) {
+                return false;
+            }
 
-    if ((table->rows = malloc(TABLE_START_CAPACITY * sizeof(Row *))) == NULL) {
-        free(table);
-        return NULL;
+            // The next cell starts behind the delimiter
+            expected = cell->raw + cell->rawSize;
+            if (expected < end && isDelimiter(index->delimiters, *expected)) {
+                expected++;
+            } else {
+                ended = true;
+            }
+        }
+    }
+
+    if (row->tail != NULL) {
+        return !ended && row->tail == expected;
+    }
+
+    return ended;
+}
+
+/**
+ * Measures memory used by cells of the loaded row
+ * @param row Row to measure
+ * @return Used memory (in bytes)
+ */
+size_t measureRowMemory(Row *row) {
+    size_t memory = sizeof(RowPage) + row->capacity * sizeof(Cell *) + row->loaded * sizeof(Cell);
+    for (unsigned i = 0; i < row->loaded; i++) {
+        if (ownsCellData(row->cells[i])) {
+            memory += row->cells[i]->content.allocated.capacity + 1;
+        }
     }
 
-    return table;
+    return memory;
 }
 
 /**
- * Creates a new row
- * @return Pointer to the new row or NULL if error occurred
+ * Deletes the row from the table
+ * @param table Table to edit
+ * @param position Position with the row to delete (1 = first)
+ * @return Error information
  */
-Row *createRow() {
-    Row *row;
-    if ((row = malloc(sizeof(Row))) == NULL) {
-        return NULL;
+ErrorInfo deleteRowFromTable(Table *table, unsigned int position) {
+    ErrorInfo err = {.error = false};
+
+    // Row behind the table (the selected rows get behind it, while they're deleted one by one) deletes the last row
+    // of the table, the same way as deleting of columns does
+    if (table->size == 0) {
+        return err;
+    } else if (position > table->size) {
+        position = table->size;
     }
 
-    row->size = 0;
-    row->capacity = ROW_START_CAPACITY;
+    // There are coordinates from the real world in row and column (indexed from 1) --> - 1
+    position--;
 
-    if ((row->cells = malloc(ROW_START_CAPACITY * sizeof(Cell *))) == NULL) {
-        free(row);
-        return NULL;
+    // The gap is moved behind the row (only rows between them are moved), so the row can be added to the gap
+    moveRowGap(table, position + 1);
+
+    // Destruct the row (cells of the columnar table's row are in its columns)
+    destructRow(table->rows[position]);
+    for (unsigned j = 0; j < table->width; j++) {
+        destructCell(table->columns[j].cells[position]);
     }
 
-    return row;
+    // The size has been changed
+    table->size--;
+    table->gap = (position < table->size ? position : NO_ROW_GAP);
+    markRowAsModified(table, position);
+
+    return err;
 }
 
 /**
- * Creates a new cell
- * @return Pointer to the new cell or NULL if error occurred
+ * Deletes the column from the table
+ * @param table Table to edit
+ * @param columnNumber Number of column to delete (1 = first)
+ * @return Error information
  */
-Cell *createCell() {
-    Cell *cell;
-    if ((cell = malloc(sizeof(Cell))) == NULL) {
-        return NULL;
+ErrorInfo deleteColumnFromTable(Table *table, unsigned int columnNumber) {
+    ErrorInfo err = {.error = false};
+
+    // Column behind the table (the selected columns get behind it, while they're deleted one by one) deletes the last
+    // column of the table, the same way as the original row-major deleting did
+    unsigned width = getTableWidth(table);
+    if (width == 0) {
+        return err;
+    } else if (columnNumber > width) {
+        columnNumber = width;
     }
 
-    cell->size = 0;
-    cell->capacity = CELL_START_CAPACITY;
+    // There are coordinates from the real world in row and column (indexed from 1) --> - 1
+    columnNumber--;
 
-    // The last '\0' --> + 1
-    if ((cell->data = malloc((CELL_START_CAPACITY + 1) * sizeof(char))) == NULL) {
-        free(cell);
-        return NULL;
+    // Column of the columnar table is deleted at once
+    markRowAsModified(table, 0);
+    if (table->columns != NULL) {
+        Column *column = &(table->columns[columnNumber]);
+        for (unsigned i = 0; i < table->size; i++) {
+            destructCell(column->cells[getRowSlot(table, i)]);
+        }
+        free(column->cells);
+
+        memmove(column, column + 1, (table->width - columnNumber - 1) * sizeof(Column));
+        table->width--;
+
+        return err;
     }
-    memset(cell->data, '\0', cell->capacity + 1);
 
-    return cell;
+    // Delete the cell on position columnNumber from every row of the table
+    for (unsigned i = 0; i < table->size; i++) {
+        // Cells can be deleted only from fully loaded row
+        Row *row = getTableRow(table, i);
+        if ((err = materializeRow(row, row->size)).error) {
+            return err;
+        }
+
+        // Destruct the cell
+        destructCell(row->cells[columnNumber]);
+
+        // Move cells to replace and fill the deleted position
+        for (unsigned j = (int)columnNumber; j < row->size - 1; j++) {
+            row->cells[j] = row->cells[j + 1];
+        }
+
+        // The size has been changed
+        row->size--;
+        row->loaded--;
+
+        if ((err = evictRows(table)).error) {
+            return err;
+        }
+    }
+
+    return err;
 }
 
 /**
- * Adds a row to a table
+ * Aligns all rows of the table to the same size
  * @param table Table to edit
- * @param row Row to add to the table
- * @param position Position in the table (1 = first)
  * @return Error information
  */
-ErrorInfo addRowToTable(Table *table, Row *row, unsigned int position) {
+ErrorInfo alignRowSizes(Table *table) {
     ErrorInfo err = {.error = false};
 
-    // There are coordinates from the real world in row and column (indexed from 1) --> - 1
-    position--;
+    // All columns of the columnar table have the same number of cells
+    if (table->columns != NULL) {
+        return err;
+    }
 
-    // Resizing table if needed
-    if (table->capacity < (table->size + 1)) {
-        if ((table->rows = realloc(table->rows, table->capacity * 2 * sizeof(Row *))) == NULL) {
-            err.error = true;
-            err.message = "Nepodarilo se rozsirit pametovy prostor pro tabulku.";
+    // Find number of cells in the biggest row (row with the most cells)
+    unsigned biggestSize = 0;
+    for (unsigned i = 0; i < table->size; i++) {
+        if (getTableRow(table, i)->size > biggestSize) {
+            biggestSize = getTableRow(table, i)->size;
+        }
+    }
+
+    // Set number of cells in each row by the row with the most cells
+    for (unsigned i = 0; i < table->size; i++) {
+        // Rows with enough cells are skipped (so rows which haven't been loaded yet aren't loaded needlessly)
+        Row *row = getTableRow(table, i);
+        if (row->size >= biggestSize) {
+            continue;
+        }
 
+        markRowAsModified(table, i);
+        if ((err = reserveRowCapacity(row, biggestSize)).error) {
             return err;
         }
 
-        table->capacity *= 2;
-    }
+        for (unsigned j = row->size; j < biggestSize; j++) {
+            // Prepare empty cell
+            Cell *cell;
+            if ((cell = createCell(table->arena)) == NULL) {
+                err.error = true;
+                err.message = "Nepodarilo se alokovat pamet pro novou bunku.";
 
-    // Free up space on specified position
-    for (unsigned i = table->size; i > position; i--) {
-        table->rows[i] = table->rows[i - 1];
-    }
+                return err;
+            }
 
-    // Insert the row to the specified position
-    table->rows[position] = row;
-    table->size++;
+            if ((err = addCellToRow(row, cell, j + 1)).error) {
+                return err;
+            }
+        }
+
+        if ((err = evictRows(table)).error) {
+            return err;
+        }
+    }
 
     return err;
 }
 
 /**
- * Adds a column to the table (inserts empty cell to all of the rows)
+ * Aligns the inserted row to the same size as the other rows of the table (only the row is checked)
+ * <strong>Warning! The rest of the table must be already aligned using alignRowSizes()</strong>
  * @param table Table to edit
- * @param position Position in the table (1 = first)
+ * @param position Position of the inserted row (1 = first)
  * @return Error information
  */
-ErrorInfo addColumnToTable(Table *table, unsigned int position) {
+ErrorInfo alignInsertedRow(Table *table, unsigned int position) {
     ErrorInfo err = {.error = false};
 
+    // All columns of the columnar table have the same number of cells, the only row has no other row to align to
+    if (table->columns != NULL || table->size < 2) {
+        return err;
+    }
+
+    // Row inserted behind the table has been added at its end
+    if (position > table->size) {
+        position = table->size;
+    }
+
     // There are coordinates from the real world in row and column (indexed from 1) --> - 1
-    position--;
+    Row *row = getTableRow(table, position - 1);
+    unsigned width = getTableRow(table, (position > 1 ? 0 : 1))->size;
+    if (row->size >= width) {
+        return err;
+    }
 
-    // Add cell to every row at specified position
-    for (unsigned i = 0; i < table->size; i++) {
+    markRowAsModified(table, position - 1);
+    if ((err = reserveRowCapacity(row, width)).error) {
+        return err;
+    }
+
+    for (unsigned j = row->size; j < width; j++) {
+        // Prepare empty cell
         Cell *cell;
-        if ((cell = createCell()) == NULL) {
+        if ((cell = createCell(table->arena)) == NULL) {
             err.error = true;
             err.message = "Nepodarilo se alokovat pamet pro novou bunku.";
 
             return err;
         }
 
-        if ((err = addCellToRow(table->rows[i], cell, position + 1)).error) {
+        if ((err = addCellToRow(row, cell, j + 1)).error) {
             return err;
         }
     }
 
-    return err;
+    return evictRows(table);
 }
 
 /**
- * Adds a cell to a row
- * @param row Row to edit
- * @param cell Cell to add to the row
- * @param position Position in the row (1 = first)
+ * Trims rows of the table (removes empty column at the end of the table)
+ * @param table Table to edit
  * @return Error information
  */
-ErrorInfo addCellToRow(Row *row, Cell *cell, unsigned int position) {
+ErrorInfo trimRows(Table *table) {
     ErrorInfo err = {.error = false};
 
-    // There are coordinates from the real world in row and column (indexed from 1) --> - 1
-    position--;
+    // Get the maximum number of columns in the row
+    unsigned mostColumns = 0;
+    for (unsigned i = 0; i < table->size; i++) {
+        // Row which hasn't been found in the indexed data yet is checked only if it can have more filled columns
+        // (it's known from the index)
+        // Evicted row is checked the same way (its filled columns have been saved while evicting)
+        Row *row = getTableRow(table, i);
+        if (row->source != NULL) {
+            if (row->source->filledColumns[row->sourceRow / row->source->stride] <= mostColumns) {
+                continue;
+            }
 
-    // Resizing the row if needed
-    if (row->capacity < (row->size + 1)) {
-        if ((row->cells = realloc(row->cells, row->capacity * 2 * sizeof(Cell *))) == NULL) {
-            err.error = true;
-            err.message = "Nepodarilo se rozsirit pametovy prostor pro radek.";
+            if ((err = materializeRow(row, 0)).error) {
+                return err;
+            }
+        } else if (row->page != NULL && row->page->evicted) {
+            if (row->page->filled <= mostColumns) {
+                continue;
+            }
 
-            return err;
+            if ((err = materializeRow(row, 0)).error) {
+                return err;
+            }
         }
 
-        row->capacity *= 2;
-    }
+        unsigned validColumns = getFilledColumns(row);
+        if (validColumns > mostColumns) {
+            mostColumns = validColumns;
+        }
 
-    // Free up the space on specified position
-    for (unsigned i = row->size; i > position; i--) {
-        row->cells[i] = row->cells[i - 1];
+        if ((err = evictRows(table)).error) {
+            return err;
+        }
     }
 
-    // Insert the cell to the specified position
-    row->cells[position] = cell;
-    row->size++;
+    // Delete all unnecessary columns
+    for (unsigned j = getTableRow(table, 0)->size; j > mostColumns; j--) {
+        if ((err = deleteColumnFromTable(table, j)).error) {
+            return err;
+        }
+    }
 
     return err;
 }
 
 /**
- * Adds a char to the cell
- * @param cell Cell to edit
- * @param c Char to insert
- * @param position Position in the cell (1 = first)
+ * Finds out the number of the last non-empty column in the row
+ * @param row Row to check (it mustn't be the row which hasn't been found in the indexed data)
+ * @return Number of the last non-empty column (0 if all of the cells are empty)
+ */
+unsigned int getFilledColumns(Row *row) {
+    // Filled columns of the raw tail are known from its loading
+    unsigned filled = row->tailFilled;
+    for (unsigned j = 0; j < row->loaded; j++) {
+        if (row->cells[j]->size != 0 && j + 1 > filled) {
+            filled = j + 1;
+        }
+    }
+    for (unsigned j = 0; row->spans != NULL && j < row->size; j++) {
+        if (row->spans[j].size != 0) {
+            filled = j + 1;
+        }
+    }
+
+    return filled;
+}
+
+/**
+ * Resizes the table to a new size
+ * <strong>Warning! The table must be already aligned using alignRowSizes()</strong>
+ * @param table Table to resize
+ * @param rows New number of rows
+ * @param columns New number of columns
  * @return Error information
  */
-ErrorInfo addCharToCell(Cell *cell, char c, unsigned int position) {
+ErrorInfo resizeTable(Table *table, unsigned int rows, unsigned int columns) {
     ErrorInfo err = {.error = false};
 
-    // There are coordinates from the real world in row and column (indexed from 1) --> - 1
-    position--;
+    // Missing columns are added to the columnar table as a whole
+    for (unsigned i = table->width; table->columns != NULL && i < columns; i++) {
+        if ((err = addColumnToTable(table, i + 1)).error) {
+            return err;
+        }
+    }
 
-    // Resize data for the cell if needed
-    if (cell->capacity < (cell->size + 1)) {
-        // The last '\0' --> + 1
-        if ((cell->data = realloc(cell->data, (2 * cell->capacity + 1) * sizeof(char))) == NULL) {
+    // Add missing rows (at first, so the table without rows gets the first row for the missing columns)
+    for (unsigned i = table->size; i < rows; i++) {
+        // Prepare the new row
+        Row *row;
+        if ((row = createRow(ROW_START_CAPACITY)) == NULL) {
             err.error = true;
-            err.message = "Nepodarilo se rozsirit pametovy prostor pro bunku.";
+            err.message = "Nepodarilo se alokovat pamet pro novy radek.";
 
             return err;
         }
 
-        cell->capacity *= 2;
+        // Add the row into table
+        if ((err = addRowToTable(table, row, i + 1)).error) {
+            return err;
+        }
     }
 
-    // Fill newly allocated space with zero bytes
-    memset(&(cell->data[cell->size]), '\0', cell->capacity - cell->size + 1);
+    // Add missing columns to the first row (it will be distributed automatically by calling alignRowSizes() function)
+    // Table without rows has no row for them
+    for (unsigned i = getTableWidth(table); table->size > 0 && i < columns; i++) {
+        // Prepare the new cell
+        Cell *cell;
+        if ((cell = createCell(table->arena)) == NULL) {
+            err.error = true;
+            err.message = "Nepodarilo se alokovat pamet pro novou bunku.";
 
-    // Free up the space on specified position
-    for (unsigned i = cell->size; i > position; i--) {
-        cell->data[i] = cell->data[i - 1];
+            return err;
+        }
+
+        // Add the cell to the row
+        markRowAsModified(table, 0);
+        if ((err = addCellToRow(getTableRow(table, 0), cell, i + 1)).error) {
+            return err;
+        }
     }
 
-    // Append char to the cell data (cell.size == last index + 1)
-    cell->data[position] = c;
-    cell->size++;
+    // Add missing empty cells
+    alignRowSizes(table);
 
     return err;
 }
 
 /**
- * Deletes the row from the table
- * @param table Table to edit
- * @param position Position with the row to delete (1 = first)
+ * Converts the table to the columnar one (cells of its rows are moved into columns)
+ * Columns are inserted and deleted at once in the columnar table, but all of its cells are loaded. Its rows have no
+ * cells until the table is converted back using convertTableToRows().
+ * <strong>Warning! The table must be already aligned using alignRowSizes()</strong>
+ * @param table Table to convert
+ * @return Error information
  */
-void deleteRowFromTable(Table *table, unsigned int position) {
-    // There are coordinates from the real world in row and column (indexed from 1) --> - 1
-    position--;
+ErrorInfo convertTableToColumns(Table *table) {
+    ErrorInfo err = {.error = false};
 
-    // Destruct the row
-    destructRow(table->rows[position]);
+    // All cells are loaded at first, so the table stays row-major if anything fails
+    unsigned width = getTableRow(table, 0)->size;
+    for (unsigned i = 0; i < table->size; i++) {
+        if ((err = materializeRow(getTableRow(table, i), width)).error) {
+            return err;
+        }
+    }
+
+    // Space for at least one column, so the table can be widened by doubling
+    Column *columns;
+    if ((columns = malloc((width > 0 ? width : 1) * sizeof(Column))) == NULL) {
+        err.error = true;
+        err.message = "Nepodarilo se alokovat pamet pro sloupce tabulky.";
 
-    // Move rows to replace and fill the deleted position
-    for (unsigned i = position; i < table->size - 1; i++) {
-        table->rows[i] = table->rows[i + 1];
+        return err;
     }
+    for (unsigned j = 0; j < width; j++) {
+        if ((columns[j].cells = malloc(table->capacity * sizeof(Cell *))) == NULL) {
+            for (unsigned k = 0; k < j; k++) {
+                free(columns[k].cells);
+            }
+            free(columns);
 
-    // The size has been changed
-    table->size--;
-}
+            err.error = true;
+            err.message = "Nepodarilo se alokovat pamet pro sloupce tabulky.";
 
-/**
- * Deletes the column from the table
- * @param table Table to edit
- * @param columnNumber Number of column to delete (1 = first)
- */
-void deleteColumnFromTable(Table *table, unsigned int columnNumber) {
-    // There are coordinates from the real world in row and column (indexed from 1) --> - 1
-    columnNumber--;
+            return err;
+        }
+    }
+    table->columns = columns;
+    table->width = width;
+    table->columnsCapacity = (width > 0 ? width : 1);
 
-    // Delete the cell on position columnNumber from every row of the table
+    // Cells are moved into the columns row by row
     for (unsigned i = 0; i < table->size; i++) {
-        // Destruct the cell
-        destructCell(table->rows[i]->cells[columnNumber]);
-
-        // Move cells to replace and fill the deleted position
-        for (unsigned j = (int)columnNumber; j < table->rows[i]->size - 1; j++) {
-            table->rows[i]->cells[j] = table->rows[i]->cells[j + 1];
+        Row *row = getTableRow(table, i);
+        for (unsigned j = 0; j < width; j++) {
+            table->columns[j].cells[getRowSlot(table, i)] = row->cells[j];
         }
 
-        // The size has been changed
-        table->rows[i]->size--;
+        free(row->cells);
+        row->cells = NULL;
+        row->capacity = 0;
+        row->size = 0;
+        row->loaded = 0;
     }
+
+    return err;
 }
 
 /**
- * Aligns all rows of the table to the same size
- * @param table Table to edit
+ * Converts the columnar table back to the row-major one (cells are moved from its columns into its rows)
+ * If it fails, the table stays columnar, but it can be destructed (cells of each row are either in the row or in
+ * the columns).
+ * @param table Table to convert
  * @return Error information
  */
-ErrorInfo alignRowSizes(Table *table) {
+ErrorInfo convertTableToRows(Table *table) {
     ErrorInfo err = {.error = false};
 
-    // Find number of cells in the biggest row (row with the most cells)
-    unsigned biggestRow = 0;
-    for (unsigned i = biggestRow + 1; i < table->size; i++) {
-        if (table->rows[i]->size > table->rows[biggestRow]->size) {
-            biggestRow = i;
+    unsigned width = table->width;
+    for (unsigned i = 0; i < table->size; i++) {
+        Cell **cells;
+        if ((cells = malloc((width > 0 ? width : 1) * sizeof(Cell *))) == NULL) {
+            err.error = true;
+            err.message = "Nepodarilo se alokovat pamet pro radek.";
+
+            return err;
         }
-    }
 
-    // Set number of cells in each row by the row with the most cells
-    for (unsigned i = 0; i < table->size; i++) {
-        for (unsigned j = table->rows[i]->size; j < table->rows[biggestRow]->size; j++) {
-            // Prepare empty cell
-            Cell *cell;
-            if ((cell = createCell()) == NULL) {
+        // Empty cells which haven't been needed yet are created now
+        for (unsigned j = 0; j < width; j++) {
+            if ((cells[j] = getColumnCell(table, i, j)) == NULL) {
+                free(cells);
+
                 err.error = true;
                 err.message = "Nepodarilo se alokovat pamet pro novou bunku.";
 
                 return err;
             }
+        }
 
-            if ((err = addCellToRow(table->rows[i], cell, j + 1)).error) {
-                return err;
-            }
+        Row *row = getTableRow(table, i);
+        free(row->cells);
+        row->cells = cells;
+        row->capacity = (width > 0 ? width : 1);
+        row->size = width;
+        row->loaded = width;
+        for (unsigned j = 0; j < width; j++) {
+            table->columns[j].cells[getRowSlot(table, i)] = NULL;
         }
     }
 
+    // The cells are only in the rows now
+    for (unsigned j = 0; j < width; j++) {
+        free(table->columns[j].cells);
+    }
+    free(table->columns);
+    table->columns = NULL;
+    table->width = 0;
+    table->columnsCapacity = 0;
+
     return err;
 }
 
 /**
- * Trims rows of the table (removes empty column at the end of the table)
- * @param table Table to edit
+ * Returns a cell of the columnar table (empty cell is created if it hasn't been needed yet)
+ * @param table Columnar table with the cell
+ * @param row Row of the cell (indexed from 0)
+ * @param column Column of the cell (indexed from 0)
+ * @return The cell or NULL if it can't be allocated
  */
-void trimRows(Table *table) {
-    // Get the maximum number of columns in the row
-    unsigned mostColumns = 0;
-    for (unsigned i = 0; i < table->size; i++) {
-        unsigned validColumns = 0;
-        for (unsigned j = 0; j < table->rows[i]->size; j++) {
-            if (table->rows[i]->cells[j]->size != 0) {
-                validColumns = j + 1;
-            }
-        }
-
-        if (validColumns > mostColumns) {
-            mostColumns = validColumns;
-        }
+Cell *getColumnCell(Table *table, unsigned int row, unsigned int column) {
+    Cell **cells = table->columns[column].cells;
+    unsigned slot = getRowSlot(table, row);
+    if (cells[slot] == NULL) {
+        cells[slot] = createCell(table->arena);
     }
 
-    // Delete all unnecessary columns
-    for (unsigned j = table->rows[0]->size; j > mostColumns; j--) {
-        deleteColumnFromTable(table, j + 1);
-    }
+    return cells[slot];
 }
 
 /**
- * Resizes the table to a new size
+ * Finds out the number of columns of the table
  * <strong>Warning! The table must be already aligned using alignRowSizes()</strong>
- * @param table Table to resize
- * @param rows New number of rows
- * @param columns New number of columns
- * @return Error information
+ * @param table Table to check
+ * @return Number of columns
  */
-ErrorInfo resizeTable(Table *table, unsigned int rows, unsigned int columns) {
-    ErrorInfo err = {.error = false};
+unsigned int getTableWidth(Table *table) {
+    if (table->columns != NULL) {
+        return table->width;
+    }
 
-    // Add missing columns to the first row (it will be distributed automatically by calling alignRowSizes() function)
-    for (unsigned i = table->rows[0]->size; i < columns; i++) {
-        // Prepare the new cell
-        Cell *cell;
-        if ((cell = createCell()) == NULL) {
-            err.error = true;
-            err.message = "Nepodarilo se alokovat pamet pro novou bunku.";
+    // Table without rows has no columns (all of its rows have been deleted)
+    return (table->size > 0 ? getTableRow(table, 0)->size : 0);
+}
 
-            return err;
-        }
+/**
+ * Returns a row of the table
+ * @param table Table with the row
+ * @param row Number of the row (indexed from 0)
+ * @return The row
+ */
+Row *getTableRow(Table *table, unsigned int row) {
+    return table->rows[getRowSlot(table, row)];
+}
 
-        // Add the cell to the row
-        if ((err = addCellToRow(table->rows[0], cell, i + 1)).error) {
-            return err;
-        }
+/**
+ * Finds out where the row of the table is stored (rows behind the gap are at the end of the array)
+ * Cells of the columnar table's columns are stored the same way.
+ * @param table Table with the row
+ * @param row Number of the row (indexed from 0)
+ * @return Index of the row in the array of rows
+ */
+unsigned int getRowSlot(Table *table, unsigned int row) {
+    return (row < table->gap ? row : row + (table->capacity - table->size));
+}
+
+/**
+ * Moves the gap in rows of the table (and in columns of the columnar table) to a new position
+ * Only rows between the old and the new position of the gap are moved, so rows are inserted and deleted at nearby
+ * positions (for ex. for each row of the selection) without moving all rows behind them. Moving the gap still costs
+ * the distance between both positions (for each column of the columnar table too), so inserting and deleting rows
+ * at scattered positions is as slow as moving all rows behind them.
+ * @param table Table to edit
+ * @param position New position of the gap (indexed from 0, the number of rows to store one after another)
+ */
+void moveRowGap(Table *table, unsigned int position) {
+    unsigned gap = (table->gap < table->size ? table->gap : table->size);
+    unsigned gapSize = table->capacity - table->size;
+
+    // Rows before the new position are moved in front of the gap, rows behind it are moved behind the gap
+    unsigned from = (position < gap ? position : gap + gapSize);
+    unsigned to = (position < gap ? position + gapSize : gap);
+    unsigned count = (position < gap ? gap - position : position - gap);
+    memmove(table->rows + to, table->rows + from, count * sizeof(Row *));
+    for (unsigned j = 0; j < table->width; j++) {
+        memmove(table->columns[j].cells + to, table->columns[j].cells + from, count * sizeof(Cell *));
     }
 
-    // Add missing rows
-    for (unsigned i = table->size; i < rows; i++) {
-        // Prepare the new row
-        Row *row;
-        if ((row = createRow()) == NULL) {
-            err.error = true;
-            err.message = "Nepodarilo se alokovat pamet pro novy radek.";
+    table->gap = (position < table->size ? position : NO_ROW_GAP);
+}
 
-            return err;
-        }
+/**
+ * Marks the row as modified (rows before the first modified row are the same as in the loaded data)
+ * @param table Table with the row
+ * @param row Number of the row (indexed from 0)
+ */
+void markRowAsModified(Table *table, unsigned int row) {
+    if (row < table->modifiedRow) {
+        table->modifiedRow = row;
+    }
+}
 
-        // Add the row into table
-        if ((err = addRowToTable(table, row, i + 1)).error) {
-            return err;
+/**
+ * Checks if the saved table would be exactly the same as its indexed data
+ * It's true for tables which haven't been modified and their data are in the canonical form without empty columns
+ * at the end (saveTableToFile() copies the data as they are).
+ * @param table Table to check
+ * @return Would be the saved table the same as its indexed data?
+ */
+bool isSavedAsIndexed(Table *table) {
+    RowIndex *index = table->index;
+    if (table->modifiedRow != NOT_MODIFIED_ROW || index == NULL || !index->canonical || index->size == 0
+        || index->size != table->size) {
+        return false;
+    }
+
+    // Empty columns at the end of all rows would be trimmed
+    unsigned filled = 0;
+    for (unsigned i = 0; i <= (index->size - 1) / index->stride; i++) {
+        if (index->filledColumns[i] > filled) {
+            filled = index->filledColumns[i];
         }
     }
 
-    // Add missing empty cells
-    alignRowSizes(table);
+    return filled == index->width;
+}
 
-    return err;
+/**
+ * Checks if the saved row would be exactly the same as in the indexed data of the table
+ * It's true for rows which haven't been loaded from the indexed data in the canonical form and for rows before
+ * the first modified row (they can't be changed, even if they've been loaded).
+ * <strong>Warning! The table must be already trimmed using trimRows()</strong>
+ * @param table Table with the row
+ * @param row Number of the row (indexed from 0)
+ * @return Would be the saved row the same as in the indexed data?
+ */
+bool isRowSavedAsIndexed(Table *table, unsigned int row) {
+    RowIndex *index = table->index;
+    if (index == NULL || !index->canonical) {
+        return false;
+    }
+
+    return getTableRow(table, row)->source != NULL || (row < table->modifiedRow && getTableRow(table, row)->sourceRow == row);
 }
 
 /**
@@ -1079,13 +6460,29 @@ void destructTable(Table *table) {
     }
 
     for (unsigned i = 0; i < table->size; i++) {
-        destructRow(table->rows[i]);
+        destructRow(getTableRow(table, i));
+    }
+
+    // Cells of the columnar table are only in its columns
+    for (unsigned j = 0; j < table->width; j++) {
+        for (unsigned i = 0; i < table->size; i++) {
+            destructCell(table->columns[j].cells[getRowSlot(table, i)]);
+        }
+        free(table->columns[j].cells);
     }
+    free(table->columns);
 
     free(table->rows);
     table->capacity = 0;
     table->size = 0;
 
+    destructRowIndex(table->index);
+    destructPageCache(table->cache);
+
+    // Cells and compact rows have been already destructed, so their memory can be released
+    destructArena(table->arena);
+    free(table->heap);
+
     free(table);
 }
 
@@ -1099,11 +6496,19 @@ void destructRow(Row *row) {
         return;
     }
 
-    for (unsigned i = 0; i < row->size; i++) {
+    // Cells which haven't been loaded don't exist
+    for (unsigned i = 0; i < row->loaded; i++) {
         destructCell(row->cells[i]);
     }
 
+    // Loaded row of the cache isn't loaded anymore
+    if (row->page != NULL) {
+        unlistRow(row);
+        free(row->page);
+    }
+
     free(row->cells);
+    free(row->spans);
     row->capacity = 0;
     row->size = 0;
 
@@ -1120,10 +6525,15 @@ void destructCell(Cell *cell) {
         return;
     }
 
-    free(cell->data);
+    // Short data are a part of the cell, memory from the arena is released together with the arena
+    if (ownsCellData(cell)) {
+        free(cell->content.allocated.data);
+    }
     cell->size = 0;
 
-    free(cell);
+    if (!cell->inArena) {
+        free(cell);
+    }
 }
 
 /**
@@ -1137,25 +6547,72 @@ void destructCell(Cell *cell) {
 ErrorInfo setCellValue(Table *table, unsigned int row, unsigned int column, const char *newValue) {
     ErrorInfo err = {.error = false};
 
-    // Get cell and new value's size for easier manipulation
+    // Cells outside the table can't be set (the row could have been evicted, so there is no space behind its cells)
+    if (row < 1 || column < 1 || row > table->size
+        || column > (table->columns != NULL ? table->width : getTableRow(table, row - 1)->size)) {
+        err.error = true;
+        err.message = "Bunka, do ktere se ma zapsat, neni v tabulce obsazena.";
+
+        return err;
+    }
+
+    // The row is loaded from the indexed data if it hasn't been loaded yet (the columnar table is fully loaded)
     // There are coordinates from the real world in row and column (indexed from 1) --> - 1
-    Cell *cell = table->rows[row - 1]->cells[column - 1];
+    Cell *cell;
+    if (table->columns != NULL) {
+        if ((cell = getColumnCell(table, row - 1, column - 1)) == NULL) {
+            err.error = true;
+            err.message = "Nepodarilo se alokovat pamet pro novou bunku.";
+
+            return err;
+        }
+    } else {
+        Row *selected = getTableRow(table, row - 1);
+        if ((err = materializeRow(selected, column)).error) {
+            return err;
+        }
+
+        cell = selected->cells[column - 1];
+    }
+
+    // Get new value's size for easier manipulation
     int newSize = (int)strlen(newValue);
+    markRowAsModified(table, row - 1);
 
-    // Resize for the new value
+    // Short value is kept right in the cell (the new value can be the old one, so it's moved before freeing)
     // The last '\0' --> + 1
-    if ((cell->data = realloc(cell->data, (newSize + 1) * sizeof(char))) == NULL) {
-        err.error = true;
-        err.message = "Nepodarilo se rozsirit pametovy prostor bunky.";
+    char *oldData = (ownsCellData(cell) ? cell->content.allocated.data : NULL);
+    if (newSize <= CELL_SHORT_CAPACITY) {
+        memmove(cell->content.shortData, newValue, newSize + 1);
+        free(oldData);
+        cell->shortContent = true;
+    } else {
+        // Resize for the new value (short data and data from the arena can't be resized, a new allocation is made)
+        char *data;
+        if ((data = realloc(oldData, (newSize + 1) * sizeof(char))) == NULL) {
+            err.error = true;
+            err.message = "Nepodarilo se rozsirit pametovy prostor bunky.";
 
-        return err;
-    }
-    cell->capacity = newSize + 1;
+            return err;
+        }
 
-    // Set the new value
-    memcpy(cell->data, newValue, newSize + 1);
+        // Set the new value (it can be the old short one, so it's copied before it's overwritten)
+        memcpy(data, newValue, newSize + 1);
+        cell->shortContent = false;
+        cell->content.allocated.data = data;
+        cell->content.allocated.capacity = newSize + 1;
+    }
+    cell->dataInArena = false;
     cell->size = newSize;
 
+    // Content is different from the raw data now (its flags are given by its chars)
+    cell->raw = NULL;
+    cell->rawSize = 0;
+    cell->flags = 0;
+    for (int i = 0; i < newSize; i++) {
+        cell->flags |= getCharFlags(table->delimiters, newValue[i]);
+    }
+
     return err;
 }
 
@@ -1164,18 +6621,44 @@ ErrorInfo setCellValue(Table *table, unsigned int row, unsigned int column, cons
  * @param table Table contains the selected cell
  * @param row Selected row (1 = first)
  * @param column Selected column (1 = first)
- * @return Value of the cell
+ * @return Value of the cell or NULL if the cell isn't in the table or its content can't be allocated
  */
 char *getCellValue(Table *table, unsigned int row, unsigned int column) {
     // There are coordinates from the real world in row and column (indexed from 1) --> - 1
     row--;
     column--;
 
-    if (((table->size - 1) < row) || ((table->rows[0]->size - 1) < column)) {
+    if (row >= table->size || column >= getTableWidth(table)) {
         return NULL;
     }
 
-    return table->rows[row]->cells[column]->data;
+    // Cell of the columnar table is taken from its column
+    if (table->columns != NULL) {
+        Cell *cell;
+        if ((cell = getColumnCell(table, row, column)) == NULL || materializeCell(cell, table->arena).error) {
+            return NULL;
+        }
+
+        return getCellData(cell);
+    }
+
+    // Content of the compact row's cell is read right from the heap (the row stays compact)
+    Row *selected = getTableRow(table, row);
+    if (selected->spans != NULL && column < selected->size) {
+        return selected->heap + selected->spans[column].offset;
+    }
+
+    // Row and content of the cell are loaded from the input data when they're needed for the first time
+    if (materializeRow(selected, column + 1).error) {
+        return NULL;
+    }
+
+    Cell *cell = selected->cells[column];
+    if (materializeCell(cell, table->arena).error) {
+        return NULL;
+    }
+
+    return getCellData(cell);
 }
 
 /**********************************************************************************Functions for working with commands*/
@@ -1273,6 +6756,104 @@ void convertTypesInCommandParams(CommandSequence *cmdSeq) {
     }
 }
 
+/**
+ * Finds out how many columns (from the start of the table) the commands can work with
+ * Commands can't get behind the columns given by selections and cell coordinates in their parameters, only commands
+ * for inserting and deleting columns work with all of them.
+ * @param cmdSeq Command sequence to check
+ * @return Number of used columns (UINT_MAX if all of them can be used)
+ */
+unsigned int getUsedColumns(CommandSequence *cmdSeq) {
+    // The default selection is [1,1]
+    unsigned columns = 1;
+
+    Command *cmd = cmdSeq->firstCmd;
+    while (cmd != NULL) {
+        int usedColumns[2] = {0, 0};
+        if (isColumnCommand(cmd)) {
+            return UINT_MAX;
+        } else if (cmd->type == SELECTION_COMMAND && streq(cmd->name, "select")) {
+            // [R,C] and [R1,C1,R2,C2] ([_] only restores some of previous selections)
+            usedColumns[0] = cmd->intParams[1];
+            usedColumns[1] = cmd->intParams[3];
+        } else if (streq(cmd->name, "swap") || streq(cmd->name, "sum") || streq(cmd->name, "avg")
+                   || streq(cmd->name, "count") || streq(cmd->name, "len")) {
+            // Cell coordinates [R,C] in parameters
+            usedColumns[0] = cmd->intParams[1];
+        }
+
+        for (unsigned i = 0; i < 2; i++) {
+            if (usedColumns[i] < 0) {
+                // Last column ('_')
+                return UINT_MAX;
+            } else if ((unsigned)usedColumns[i] > columns) {
+                columns = (unsigned)usedColumns[i];
+            }
+        }
+
+        // Move to the next command
+        cmd = cmd->next;
+    }
+
+    return columns;
+}
+
+/**
+ * Checks if the commands work with each row of the table separately and the same way for all rows
+ * Only whole columns can be selected ([_,C] and [_,_], the selection can be saved and restored using [set] and [_])
+ * and only set and clear commands can edit them. Rows of the table can be processed one by one for such commands.
+ * @param cmdSeq Command sequence to check
+ * @return Are the commands row-local?
+ */
+bool isRowLocal(CommandSequence *cmdSeq) {
+    // The default selection is [1,1], which isn't row-local
+    bool selected = false;
+    bool saved = false;
+
+    Command *cmd = cmdSeq->firstCmd;
+    while (cmd != NULL) {
+        if (cmd->type == SELECTION_COMMAND && streq(cmd->name, "select")) {
+            int row = cmd->intParams[0];
+            int col = cmd->intParams[1];
+            if (row == LAST_ROW_COL_NUMBER && col == BAD_ROW_COL_NUMBER) {
+                // [_] (reading the selection variable before saving any selection into it isn't defined)
+                if (!saved) {
+                    return false;
+                }
+            } else if (row != LAST_ROW_COL_NUMBER || (col != LAST_ROW_COL_NUMBER && col < 1)
+                       || cmd->intParams[2] != BAD_ROW_COL_NUMBER || cmd->intParams[3] != BAD_ROW_COL_NUMBER) {
+                return false;
+            }
+
+            selected = true;
+        } else if (cmd->type == SELECTION_COMMAND && streq(cmd->name, "set-v")) {
+            // [set]
+            if (!selected) {
+                return false;
+            }
+
+            saved = true;
+        } else if (cmd->type != CLASSIC_COMMAND || !selected
+                   || !(streq(cmd->name, "set") || streq(cmd->name, "clear"))) {
+            return false;
+        }
+
+        // Move to the next command in sequence
+        cmd = cmd->next;
+    }
+
+    return selected;
+}
+
+/**
+ * Checks if the command inserts or deletes columns of the table
+ * @param cmd Command to check
+ * @return Is it icol, acol or dcol command?
+ */
+bool isColumnCommand(Command *cmd) {
+    return streq(cmd->name, "icol") || streq(cmd->name, "acol") || streq(cmd->name, "dcol");
+}
+
 /**
  * Destructs command sequence
  * @param cmdSeq Command sequence to be destructed
@@ -1361,9 +6942,10 @@ ErrorInfo processCommands(CommandSequence *cmdSeq, Table *table) {
         return err;
     }
 
-    // Apply each command from the sequence
+    // Apply each command from the sequence (the processing stops at the first error)
+    unsigned long columnOperations = 0;
     Command *cmd = cmdSeq->firstCmd;
-    while (cmd != NULL) {
+    while (cmd != NULL && !err.error) {
         // Find related function
         int found = -1;
         for (unsigned i = 0; i < sizeof(names) / sizeof(char *); i++) {
@@ -1378,25 +6960,37 @@ ErrorInfo processCommands(CommandSequence *cmdSeq, Table *table) {
             err.error = true;
             err.message = "Byl zadan prikaz, ktery neni definovan.";
 
-            return err;
+            break;
+        }
+
+        // Columns are inserted and deleted at once in the columnar table, the table is converted when there are enough
+        // of such operations (the indexed table and the table with the cache stay row-major, their rows would have
+        // to be loaded)
+        if (cmd->type != SELECTION_COMMAND && isColumnCommand(cmd) && table->columns == NULL) {
+            columnOperations += (unsigned long)(sel->rowTo - sel->rowFrom + 1) * (sel->colTo - sel->colFrom + 1);
+            if (columnOperations >= COLUMNAR_MIN_OPERATIONS && table->index == NULL && table->cache == NULL
+                && table->size > 1 && (err = convertTableToColumns(table)).error) {
+                break;
+            }
         }
 
         // Apply command by its type
         if (cmd->type == SELECTION_COMMAND) {
             // Selection commands are applied everytime once
-            if ((err = functions[found](cmd, table, sel, vars)).error) {
-                return err;
+            if (!(err = functions[found](cmd, table, sel, vars)).error) {
+                err = evictRows(table);
             }
         } else {
             // Other command are applied for every selected cell
-            for (unsigned i = sel->rowFrom; i <= sel->rowTo; i++) {
-                for (unsigned j = sel->colFrom; j <= sel->colTo; j++) {
+            for (unsigned i = sel->rowFrom; i <= sel->rowTo && !err.error; i++) {
+                for (unsigned j = sel->colFrom; j <= sel->colTo && !err.error; j++) {
                     // Set current coords
                     sel->curRow = i;
                     sel->curCol = j;
 
-                    if ((err = functions[found](cmd, table, sel, vars)).error) {
-                        return err;
+                    // Rows used by the function can be evicted after it (it doesn't keep pointers to their cells)
+                    if (!(err = functions[found](cmd, table, sel, vars)).error) {
+                        err = evictRows(table);
                     }
                 }
             }
@@ -1406,6 +7000,25 @@ ErrorInfo processCommands(CommandSequence *cmdSeq, Table *table) {
         cmd = cmd->next;
     }
 
+    // The columnar table is converted back even after an error (the first error is reported)
+    if (table->columns != NULL) {
+        ErrorInfo conversionErr = convertTableToRows(table);
+        if (!err.error) {
+            err = conversionErr;
+        }
+    }
+
+    // Rows are stored one after another again (rows of the table are saved in chunks of the array)
+    moveRowGap(table, table->size);
+
+    // Table without rows is saved as one empty row (as the loaded empty table, saving works with its first row)
+    if (table->size == 0) {
+        ErrorInfo resizeErr = resizeTable(table, 1, 0);
+        if (!err.error) {
+            err = resizeErr;
+        }
+    }
+
     // Selection and temporary variables deallocation
     destructSelection(sel);
     destructVars(vars);
@@ -1572,15 +7185,15 @@ ErrorInfo standardSelect(Command *cmd, Table *table, Selection *sel, Variables *
         } else {
             // R = '_'
             sel->colFrom = 1;
-            sel->colTo = table->rows[0]->size;
+            sel->colTo = getTableWidth(table);
         }
     }
 
     // Resize table if select is bigger than table size
     if (sel->rowTo > table->size) {
-        resizeTable(table, sel->rowTo, table->rows[0]->size);
+        resizeTable(table, sel->rowTo, getTableWidth(table));
     }
-    if (sel->colTo > table->rows[0]->size) {
+    if (sel->colTo > getTableWidth(table)) {
         resizeTable(table, table->size, sel->colTo);
     }
 
@@ -1626,7 +7239,7 @@ ErrorInfo windowSelect(Command *cmd, Table *table, Selection *sel, Variables *va
     sel->rowFrom = row;
     sel->rowTo = (rowSecond != LAST_ROW_COL_NUMBER ? (unsigned)rowSecond : table->size);
     sel->colFrom = col;
-    sel->colTo = (colSecond != LAST_ROW_COL_NUMBER ? (unsigned)colSecond : table->rows[0]->size);
+    sel->colTo = (colSecond != LAST_ROW_COL_NUMBER ? (unsigned)colSecond : getTableWidth(table));
 
     return err;
 }
@@ -1665,8 +7278,9 @@ ErrorInfo minMaxSelect(Command *cmd, Table *table, Selection *sel, Variables *va
     // Find minimum/maximum
     for (unsigned i = sel->rowFrom; i <= sel->rowTo; i++) {
         for (unsigned j = sel->colFrom; j <= sel->colTo; j++) {
+            // Cells of deleted rows and columns aren't in the table
             char *value = getCellValue(table, i, j);
-            if (isValidNumber(value)) {
+            if (value != NULL && isValidNumber(value)) {
                 double number = strtod(value, NULL);
                 if (coords.row == -1 || (streq(cmd->name, "min") && number < actualMinMax) || (streq(cmd->name, "max") && number > actualMinMax)) {
                     // Save the new minimum/maximum
@@ -1676,6 +7290,10 @@ ErrorInfo minMaxSelect(Command *cmd, Table *table, Selection *sel, Variables *va
                 }
             }
         }
+
+        if ((err = evictRows(table)).error) {
+            return err;
+        }
     }
 
     // No numeric values found
@@ -1720,7 +7338,9 @@ ErrorInfo findSelect(Command *cmd, Table *table, Selection *sel, Variables *vars
     // Find the cell with STR
     for (unsigned i = sel->rowFrom; i <= sel->rowTo; i++) {
         for (unsigned j = sel->colFrom; j <= sel->colTo; j++) {
-            if (strstr(getCellValue(table, i, j), cmd->strParams[0]) != NULL) {
+            // Cells of deleted rows and columns aren't in the table
+            char *value = getCellValue(table, i, j);
+            if (value != NULL && strstr(value, cmd->strParams[0]) != NULL) {
                 sel->rowFrom = i;
                 sel->rowTo = i;
                 sel->colFrom = j;
@@ -1729,6 +7349,10 @@ ErrorInfo findSelect(Command *cmd, Table *table, Selection *sel, Variables *vars
                 return err;
             }
         }
+
+        if ((err = evictRows(table)).error) {
+            return err;
+        }
     }
 
     return err;
@@ -1752,7 +7376,7 @@ ErrorInfo irow(Command *cmd, Table *table, Selection *sel, Variables *vars) {
 
     // Create empty row
     Row *row;
-    if ((row = createRow()) == NULL) {
+    if ((row = createRow(ROW_START_CAPACITY)) == NULL) {
         err.error = true;
         err.message = "Pri alokaci pameti pro novy radek doslo k chybe.";
 
@@ -1763,7 +7387,7 @@ ErrorInfo irow(Command *cmd, Table *table, Selection *sel, Variables *vars) {
     if ((err = addRowToTable(table, row, sel->curRow)).error) {
         return err;
     }
-    if ((err = alignRowSizes(table)).error) {
+    if ((err = alignInsertedRow(table, sel->curRow)).error) {
         return err;
     }
 
@@ -1787,7 +7411,7 @@ ErrorInfo arow(Command *cmd, Table *table, Selection *sel, Variables *vars) {
 
     // Create empty row
     Row *row;
-    if ((row = createRow()) == NULL) {
+    if ((row = createRow(ROW_START_CAPACITY)) == NULL) {
         err.error = true;
         err.message = "Pri alokaci pameti pro novy radek doslo k chybe.";
 
@@ -1798,7 +7422,7 @@ ErrorInfo arow(Command *cmd, Table *table, Selection *sel, Variables *vars) {
     if ((err = addRowToTable(table, row, sel->curRow + 1)).error) {
         return err;
     }
-    if ((err = alignRowSizes(table)).error) {
+    if ((err = alignInsertedRow(table, sel->curRow + 1)).error) {
         return err;
     }
 
@@ -1821,7 +7445,7 @@ ErrorInfo drow(Command *cmd, Table *table, Selection *sel, Variables *vars) {
     (void)vars;
 
     // Delete row
-    deleteRowFromTable(table, sel->curRow);
+    err = deleteRowFromTable(table, sel->curRow);
 
     return err;
 }
@@ -1888,7 +7512,7 @@ ErrorInfo dcol(Command *cmd, Table *table, Selection *sel, Variables *vars) {
     (void)vars;
 
     // Delete column
-    deleteColumnFromTable(table, sel->curCol);
+    err = deleteColumnFromTable(table, sel->curCol);
 
     return err;
 }
@@ -1965,9 +7589,10 @@ ErrorInfo swapEdit(Command *cmd, Table *table, Selection *sel, Variables *vars)
     }
 
     // Get values of both cells
-    char *selCell = getCellValue(table, sel->curRow, sel->curCol);
+    char *selCell;
     char *argCell;
-    if ((argCell = getCellValue(table, argRow, argCol)) == NULL) {
+    if ((selCell = getCellValue(table, sel->curRow, sel->curCol)) == NULL
+        || (argCell = getCellValue(table, argRow, argCol)) == NULL) {
         err.error = true;
         err.message = "Funkce swap vyzaduje vyber takove bunky, ktera je v tabulce obsazena.";
 
@@ -2026,8 +7651,8 @@ ErrorInfo sumAvgEdit(Command *cmd, Table *table, Selection *sel, Variables *vars
     // Actual selection cell value
     char *selCell = getCellValue(table, sel->curRow, sel->curCol);
 
-    // This selection cell is not numeric --> cannot be added to the sum
-    if (!isValidNumber(selCell)) {
+    // This selection cell is not numeric (or it isn't in the table) --> cannot be added to the sum
+    if (selCell == NULL || !isValidNumber(selCell)) {
         return err;
     }
 
@@ -2085,8 +7710,10 @@ ErrorInfo countEdit(Command *cmd, Table *table, Selection *sel, Variables *vars)
         }
     }
 
-    // If selection cell has non-empty value, increment value of cell with result
-    if (!streq(getCellValue(table, sel->curRow, sel->curCol), "")) {
+    // If selection cell has non-empty value, increment value of cell with result (cells of deleted rows and columns
+    // aren't in the table)
+    char *selCell = getCellValue(table, sel->curRow, sel->curCol);
+    if (selCell != NULL && !streq(selCell, "")) {
         // Actual arguments cell value
         char *argCell;
         if ((argCell = getCellValue(table, argRow, argCol)) == NULL) {
@@ -2136,7 +7763,14 @@ ErrorInfo lenEdit(Command *cmd, Table *table, Selection *sel, Variables *vars) {
         return err;
     }
 
-    int result = (int)strlen(getCellValue(table, sel->curRow, sel->curCol));
+    char *selCell;
+    if ((selCell = getCellValue(table, sel->curRow, sel->curCol)) == NULL) {
+        err.error = true;
+        err.message = "Funkce len vyzaduje vyber takove bunky, ktera je v tabulce obsazena.";
+
+        return err;
+    }
+    int result = (int)strlen(selCell);
 
     // Save the result
     char textResult[20];
@@ -2172,7 +7806,13 @@ ErrorInfo defVars(Command *cmd, Table *table, Selection *sel, Variables *vars) {
     int varNumber = (int)cmd->strParams[0][1] - '0';
 
     // Get value from the cell
-    char *value =getCellValue(table, sel->curRow, sel->curCol);
+    char *value;
+    if ((value = getCellValue(table, sel->curRow, sel->curCol)) == NULL) {
+        err.error = true;
+        err.message = "Funkce def vyzaduje vyber takove bunky, ktera je v tabulce obsazena.";
+
+        return err;
+    }
 
     // Save selected value to the var
     if ((vars->data[varNumber] = realloc(vars->data[varNumber], strlen(value) + 1)) == NULL) {
@@ -2306,4 +7946,151 @@ bool isValidNumber(char *number) {
     }
 
     return true;
-}
\ No newline at end of file
+}
+/**
+ * Finds the first structural char (delimiter, line break, '"', '\\' or '\0' (see createDelimiterSet())) in the buffer
+ * @param data Buffer to search in
+ * @param size Size of the buffer
+ * @param delimiters Column delimiters
+ * @return Number of chars before the first structural char (size if there is no structural char)
+ */
+size_t findStructuralChar(const char *data, size_t size, DelimiterSet *delimiters) {
+    size_t i = 0;
+
+#ifdef SIMD_SCANNER
+    // Blocks of 32/16 chars are checked at once, the rest is checked char by char
+    if (delimiters->length <= SIMD_MAX_DELIMITERS) {
+        if (size >= 32 && __builtin_cpu_supports("avx2")) {
+            i = findStructuralCharAvx2(data, size, delimiters);
+        } else {
+            i = findStructuralCharSse2(data, size, delimiters);
+        }
+    }
+#endif
+
+    for (; i < size; i++) {
+        if (isStructuralChar(delimiters, data[i])) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/**
+ * Finds the start of the row in the indexed data
+ * The nearest row with known offset is taken from the index and the rest of the way is found by line breaks.
+ * @param index Index of the data
+ * @param row Number of the row (indexed from 0)
+ * @return Pointer to the start of the row (end of the data for rows behind the last one)
+ */
+const char *findIndexedRow(RowIndex *index, unsigned int row) {
+    const char *end = index->source + index->sourceSize;
+    if (row >= index->size) {
+        return end;
+    }
+
+    // Search starts from the last found row if it's on the way
+    const char *position = index->source + index->offsets[row / index->stride];
+    unsigned skippedRows = row % index->stride;
+    if (index->lastPosition != NULL && index->lastRow <= row && index->lastRow / index->stride == row / index->stride) {
+        position = index->lastPosition;
+        skippedRows = row - index->lastRow;
+    }
+
+    for (unsigned i = skippedRows; i > 0 && position < end; i--) {
+        const char *lineBreak;
+        position = ((lineBreak = memchr(position, '\n', (size_t)(end - position))) != NULL ? lineBreak + 1 : end);
+    }
+
+    index->lastRow = row;
+    index->lastPosition = position;
+
+    return position;
+}
+
+#ifdef SIMD_SCANNER
+/**
+ * Finds the first structural char (see findStructuralChar()) using SSE2 instructions (blocks of 16 chars)
+ * @param data Buffer to search in
+ * @param size Size of the buffer
+ * @param delimiters Column delimiters (at most SIMD_MAX_DELIMITERS)
+ * @return Position of the first structural char or position of the first unchecked char (the rest is too short)
+ */
+size_t findStructuralCharSse2(const char *data, size_t size, DelimiterSet *delimiters) {
+    // Prepare vectors with searched chars
+    unsigned delimitersCount = delimiters->length;
+    __m128i delimiterVectors[SIMD_MAX_DELIMITERS];
+    for (unsigned k = 0; k < delimitersCount; k++) {
+        delimiterVectors[k] = _mm_set1_epi8(delimiters->chars[k]);
+    }
+    __m128i lineBreak = _mm_set1_epi8('\n');
+    __m128i quote = _mm_set1_epi8('"');
+    __m128i backslash = _mm_set1_epi8('\\');
+    __m128i terminator = _mm_setzero_si128();
+
+    size_t i;
+    for (i = 0; i + 16 <= size; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(data + i));
+
+        // Build mask of structural chars in the block
+        __m128i found = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(block, lineBreak), _mm_cmpeq_epi8(block, terminator)),
+                _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash))
+        );
+        for (unsigned k = 0; k < delimitersCount; k++) {
+            found = _mm_or_si128(found, _mm_cmpeq_epi8(block, delimiterVectors[k]));
+        }
+
+        unsigned mask;
+        if ((mask = (unsigned)_mm_movemask_epi8(found)) != 0) {
+            return i + (size_t)__builtin_ctz(mask);
+        }
+    }
+
+    return i;
+}
+
+/**
+ * Finds the first structural char (see findStructuralChar()) using AVX2 instructions (blocks of 32 chars)
+ * It mustn't be called if the CPU doesn't support AVX2
+ * @param data Buffer to search in
+ * @param size Size of the buffer
+ * @param delimiters Column delimiters (at most SIMD_MAX_DELIMITERS)
+ * @return Position of the first structural char or position of the first unchecked char (the rest is too short)
+ */
+__attribute__((target("avx2")))
+size_t findStructuralCharAvx2(const char *data, size_t size, DelimiterSet *delimiters) {
+    // Prepare vectors with searched chars
+    unsigned delimitersCount = delimiters->length;
+    __m256i delimiterVectors[SIMD_MAX_DELIMITERS];
+    for (unsigned k = 0; k < delimitersCount; k++) {
+        delimiterVectors[k] = _mm256_set1_epi8(delimiters->chars[k]);
+    }
+    __m256i lineBreak = _mm256_set1_epi8('\n');
+    __m256i quote = _mm256_set1_epi8('"');
+    __m256i backslash = _mm256_set1_epi8('\\');
+    __m256i terminator = _mm256_setzero_si256();
+
+    size_t i;
+    for (i = 0; i + 32 <= size; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(data + i));
+
+        // Build mask of structural chars in the block
+        __m256i found = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, lineBreak), _mm256_cmpeq_epi8(block, terminator)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, backslash))
+        );
+        for (unsigned k = 0; k < delimitersCount; k++) {
+            found = _mm256_or_si256(found, _mm256_cmpeq_epi8(block, delimiterVectors[k]));
+        }
+
+        unsigned mask;
+        if ((mask = (unsigned)_mm256_movemask_epi8(found)) != 0) {
+            return i + (size_t)__builtin_ctz(mask);
+        }
+    }
+
+    return i;
+}
+#endif